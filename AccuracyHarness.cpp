@@ -0,0 +1,325 @@
+/// Differential accuracy check of the solver paths against a long double oracle, built as
+/// ballistics_accuracy with -DBALLISTICS_BUILD_ACCURACY=ON
+///
+/// Draws random in-envelope shots (distance, aim point, hood limits and flywheel all vary), solves each
+/// with every path in c_paths and with SolveShotOracle(), a long double transcription of the same
+/// equations, and reports the max and mean error in RPM and launch angle plus ULP distances. Exits
+/// with 1 when any path is over its error budget or disagrees with the oracle on feasibility, so it
+/// can gate a change to a fast path. Add new fast paths to c_paths with their own budget.
+///
+/// Where long double is no wider than double (MSVC) the oracle only catches algebraic differences,
+/// not rounding, and the harness says so.
+///
+/// Usage: ballistics_accuracy [--samples N] [--threads N] [--seed N]
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "Calculations.h"
+#include "CounterRng.h"
+#include "Parallel.h"
+#include "ShotBatch.h"
+#include "ShooterModels.h"
+#include "ShotSolver.h"
+
+using namespace std;
+
+namespace
+{
+    using Real = long double;
+
+    struct AccuracySample
+    {
+        ShooterConfig config;
+        ShotInputs inputs;
+    };
+
+    struct PathOutput
+    {
+        double rpm;
+        double angle;       // [deg]
+    };
+
+    struct OracleOutput
+    {
+        Real rpm;
+        Real angle;         // [deg]
+    };
+
+    /// Same equations as SolveShotT(), including the 1mm target stand in and the 0.0001 deg clamp threshold, in long double
+    OracleOutput SolveShotOracle(const AccuracySample& s)
+    {
+        const Real pi = 3.141592653589793238462643383279502884L;
+        const Real g = gravity.value();
+        const Real h0 = s.config.launchHeight.value();
+        const Real d = s.inputs.distance.value();
+        const Real td = s.inputs.targetDist.value() == 0.0 ? 0.001L : s.inputs.targetDist.value();
+        const Real hah = s.inputs.heightAboveHub.value();
+        const Real th = s.inputs.targetHeight.value();
+
+        Real hTarg = th - h0;
+        Real total = d + td;
+        Real hAbove = hah - h0;
+        Real x = td * d * total;
+        Real a = (d * hTarg - total * hAbove) / x;
+        Real b = (total * total * hAbove - d * d * hTarg) / x;
+        Real heightMax = -(b * b) / (4.0L * a) + h0;
+
+        Real tof = sqrtl(2.0L * (heightMax - h0) / g) + sqrtl(2.0L * (heightMax - th) / g);
+        Real vy = sqrtl(2.0L * g * (heightMax - h0));
+        Real vx = total / tof;
+
+        Real angle = atanl(vy / vx) * 180.0L / pi;
+        const Real lo = s.config.minAngle.value();
+        const Real hi = s.config.maxAngle.value();
+        if (s.config.bClampAngle && lo < hi)
+        {
+            Real clamped = angle < lo ? lo : (angle > hi ? hi : angle);
+            if (fabsl(clamped - angle) > 0.0001L)
+                angle = clamped;
+        }
+
+        Real rad = angle * pi / 180.0L;
+        Real vel = sqrtl(g * total * total / (2.0L * (total * tanl(rad) - hTarg))) / cosl(rad);
+
+        Real massRatio = static_cast<Real>(s.config.flywheelMass.value()) / static_cast<Real>(fuelMass.value());
+        Real speedFactor = 2.0L + (static_cast<Real>(fuelRotInertiaFrac.value()) + 1.0L) / (static_cast<Real>(s.config.flywheelInertiaFrac.value()) * massRatio);
+        Real rpm = vel / s.config.flywheelRadius.value() * speedFactor * 60.0L / (2.0L * pi);
+        return OracleOutput{rpm, angle};
+    }
+
+    PathOutput SolveCalculations(const AccuracySample& s, Calculations& calc)
+    {
+        calc.setPhysicalProperties(s.config.flywheelMass.value(), s.config.flywheelRadius.value(), s.config.minAngle.value(), s.config.maxAngle.value());
+        double rpm = calc.CalcInitRPMs(s.inputs.distance, s.inputs.targetDist, s.inputs.heightAboveHub, s.inputs.targetHeight).value();
+        return PathOutput{rpm, calc.GetInitAngle().value()};
+    }
+
+    PathOutput SolveStateless(const AccuracySample& s, Calculations&)
+    {
+        ShotSolution shot = SolveShot(s.config, s.inputs.distance, s.inputs.targetDist, s.inputs.heightAboveHub, s.inputs.targetHeight);
+        return PathOutput{shot.rpm.value(), shot.angleInit.value()};
+    }
+
+    PathOutput SolveDefaultModel(const AccuracySample& s, Calculations&)
+    {
+        ShotSolution shot = SolveShotT<double, DefaultShooterModel>(s.config, s.inputs.distance, s.inputs.targetDist, s.inputs.heightAboveHub, s.inputs.targetHeight);
+        return PathOutput{shot.rpm.value(), shot.angleInit.value()};
+    }
+
+    PathOutput SolveSensitivities(const AccuracySample& s, Calculations&)
+    {
+        ShotSensitivities sens = SolveShotSensitivities(s.config, s.inputs);
+        return PathOutput{sens.shot.rpm.value(), sens.shot.angleInit.value()};
+    }
+
+    /// One lane batches, failed lanes come back as NaN like the scalar solvers
+    PathOutput SolveBatchLane(const AccuracySample& s, bool bFast)
+    {
+        thread_local ShotBatchInputs inputs;
+        thread_local ShotBatchResults results;
+        inputs = ShotBatchInputs();
+        inputs.Add(s.inputs);
+        if (bFast)
+            SolveShotBatchFast(s.config, inputs, results);
+        else
+            SolveShotBatch(s.config, inputs, results);
+        if (results.status[0] > c_shotClamped)
+            return PathOutput{numeric_limits<double>::quiet_NaN(), numeric_limits<double>::quiet_NaN()};
+        return PathOutput{results.rpm[0], results.angleInit[0]};
+    }
+
+    PathOutput SolveBatch(const AccuracySample& s, Calculations&)
+    {
+        return SolveBatchLane(s, false);
+    }
+
+    PathOutput SolveBatchFast(const AccuracySample& s, Calculations&)
+    {
+        return SolveBatchLane(s, true);
+    }
+
+    struct FastPath
+    {
+        const char* name;
+        double rpmBudget;       // Max abs error [rpm]
+        double angleBudget;     // Max abs error [deg]
+        PathOutput (*solve)(const AccuracySample&, Calculations&);
+    };
+
+    const FastPath c_paths[] =
+    {
+        { "Calculations::CalcInitRPMs", 1e-6, 1e-9, SolveCalculations },
+        { "SolveShot",                  1e-6, 1e-9, SolveStateless },
+        { "SolveShotSensitivities",     1e-6, 1e-9, SolveSensitivities },
+        { "SolveShotT<DefaultModel>", 1e-6, 1e-9, SolveDefaultModel },
+        { "SolveShotBatch",             1e-6, 1e-9, SolveBatch },
+        { "SolveShotBatchFast",         0.1,  1e-3, SolveBatchFast },     // Float lanes, c_fastPathTolerance relative
+    };
+    constexpr size_t c_numPaths = sizeof(c_paths) / sizeof(c_paths[0]);
+
+    AccuracySample DrawSample(const CounterRng& rng, uint64_t index)
+    {
+        CounterRng::Block r0 = rng.Generate(index, 0);
+        CounterRng::Block r1 = rng.Generate(index, 1);
+        auto uniform = [](uint32_t u, double lo, double hi) { return lo + (hi - lo) * CounterRng::ToUniform(u); };
+
+        AccuracySample s;
+        s.config.flywheelMass = kilogram_t(uniform(r0[0], 0.2, 3.0));
+        s.config.flywheelRadius = meter_t(uniform(r0[1], 0.03, 0.08));
+        s.config.minAngle = degree_t(uniform(r0[2], 10.0, 35.0));
+        s.config.maxAngle = degree_t(uniform(r0[3], 50.0, 80.0));
+        s.inputs.distance = meter_t(uniform(r1[0], 0.5, 7.0));
+        s.inputs.targetDist = meter_t(uniform(r1[1], 0.05, meter_t(hubConeDiameter).value() - 0.05));
+
+        // One in 16 aims right at the rim, where the apex fit is ill conditioned; a quarter of those use the 1mm stand in
+        CounterRng::Block r2 = rng.Generate(index, 2);
+        if ((r2[0] & 15) == 0)
+            s.inputs.targetDist = meter_t((r2[0] & 48) == 0 ? 0.0 : uniform(r2[1], 0.001, 0.01));
+        s.inputs.heightAboveHub = meter_t(hubRimHeight) + meter_t(uniform(r1[2], 0.05, 1.0));
+        s.inputs.targetHeight = meter_t(hubRimHeight) - meter_t(uniform(r1[3], 0.0, 0.5));
+        return s;
+    }
+
+    /// Distance in units in the last place between two doubles, 0 when equal
+    uint64_t UlpDistance(double a, double b)
+    {
+        auto ordered = [](double v)
+        {
+            int64_t i;
+            memcpy(&i, &v, sizeof(i));
+            return i < 0 ? numeric_limits<int64_t>::min() - i : i;
+        };
+        int64_t ia = ordered(a);
+        int64_t ib = ordered(b);
+        return ia > ib ? static_cast<uint64_t>(ia) - static_cast<uint64_t>(ib) : static_cast<uint64_t>(ib) - static_cast<uint64_t>(ia);
+    }
+
+    struct PathErrors
+    {
+        uint64_t samples = 0;
+        uint64_t feasibilityMismatches = 0;     // One side finite, the other NaN or infinite
+        double maxRpm = 0.0;
+        double sumRpm = 0.0;
+        double maxAngle = 0.0;
+        double sumAngle = 0.0;
+        uint64_t maxUlpRpm = 0;
+        double sumUlpRpm = 0.0;
+        uint64_t maxUlpAngle = 0;
+        double sumUlpAngle = 0.0;
+
+        void Add(const PathOutput& p, const OracleOutput& o)
+        {
+            bool bOracleFinite = isfinite(static_cast<double>(o.rpm));
+            if (bOracleFinite != isfinite(p.rpm))
+            {
+                feasibilityMismatches++;
+                return;
+            }
+            if (!bOracleFinite)
+                return;
+
+            samples++;
+            double eRpm = static_cast<double>(fabsl(p.rpm - o.rpm));
+            double eAngle = static_cast<double>(fabsl(p.angle - o.angle));
+            maxRpm = std::max(maxRpm, eRpm);
+            sumRpm += eRpm;
+            maxAngle = std::max(maxAngle, eAngle);
+            sumAngle += eAngle;
+
+            uint64_t uRpm = UlpDistance(p.rpm, static_cast<double>(o.rpm));
+            uint64_t uAngle = UlpDistance(p.angle, static_cast<double>(o.angle));
+            maxUlpRpm = std::max(maxUlpRpm, uRpm);
+            sumUlpRpm += static_cast<double>(uRpm);
+            maxUlpAngle = std::max(maxUlpAngle, uAngle);
+            sumUlpAngle += static_cast<double>(uAngle);
+        }
+
+        void Merge(const PathErrors& o)
+        {
+            samples += o.samples;
+            feasibilityMismatches += o.feasibilityMismatches;
+            maxRpm = std::max(maxRpm, o.maxRpm);
+            sumRpm += o.sumRpm;
+            maxAngle = std::max(maxAngle, o.maxAngle);
+            sumAngle += o.sumAngle;
+            maxUlpRpm = std::max(maxUlpRpm, o.maxUlpRpm);
+            sumUlpRpm += o.sumUlpRpm;
+            maxUlpAngle = std::max(maxUlpAngle, o.maxUlpAngle);
+            sumUlpAngle += o.sumUlpAngle;
+        }
+    };
+
+    uint64_t ParseArg(int argc, char** argv, const char* name, uint64_t fallback)
+    {
+        for (int i = 1; i + 1 < argc; i++)
+        {
+            if (strcmp(argv[i], name) == 0)
+                return strtoull(argv[i + 1], nullptr, 10);
+        }
+        return fallback;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const uint64_t samples = ParseArg(argc, argv, "--samples", 2000000);
+    const unsigned threads = static_cast<unsigned>(ParseArg(argc, argv, "--threads", 0));
+    const CounterRng rng(ParseArg(argc, argv, "--seed", 2026));
+
+    const unsigned workers = threads == 0 ? DefaultThreadCount() : threads;
+    vector<array<PathErrors, c_numPaths>> errors(workers);
+    vector<uint64_t> infeasible(workers, 0);
+
+    ParallelFor(samples, workers, [&](size_t begin, size_t end, unsigned t)
+    {
+        Calculations calc;
+        for (size_t i = begin; i < end; i++)
+        {
+            AccuracySample s = DrawSample(rng, i);
+            OracleOutput o = SolveShotOracle(s);
+            infeasible[t] += isfinite(static_cast<double>(o.rpm)) ? 0 : 1;
+            for (size_t p = 0; p < c_numPaths; p++)
+                errors[t][p].Add(c_paths[p].solve(s, calc), o);
+        }
+    });
+
+    uint64_t totalInfeasible = 0;
+    for (uint64_t n : infeasible)
+        totalInfeasible += n;
+
+    printf("%llu samples on %u threads, %llu infeasible, oracle long double with %d mantissa bits%s\n"
+           , static_cast<unsigned long long>(samples), workers, static_cast<unsigned long long>(totalInfeasible)
+           , numeric_limits<Real>::digits
+           , numeric_limits<Real>::digits > numeric_limits<double>::digits ? "" : " (same as double, rounding differences are not visible)");
+    printf("%-28s %12s %12s %12s %12s %9s %9s %9s %9s %6s  %s\n"
+           , "path", "max rpm", "mean rpm", "max deg", "mean deg", "max ulp", "mean ulp", "max ulp", "mean ulp", "feas", "result");
+    printf("%-28s %12s %12s %12s %12s %9s %9s %9s %9s %6s\n", "", "", "", "", "", "rpm", "rpm", "deg", "deg", "diff");
+
+    bool bPass = true;
+    for (size_t p = 0; p < c_numPaths; p++)
+    {
+        PathErrors e;
+        for (const array<PathErrors, c_numPaths>& perThread : errors)
+            e.Merge(perThread[p]);
+
+        double n = e.samples > 0 ? static_cast<double>(e.samples) : 1.0;
+        bool bPathPass = e.feasibilityMismatches == 0 && e.maxRpm <= c_paths[p].rpmBudget && e.maxAngle <= c_paths[p].angleBudget;
+        bPass = bPass && bPathPass;
+        printf("%-28s %12.3e %12.3e %12.3e %12.3e %9llu %9.2f %9llu %9.2f %6llu  %s\n"
+               , c_paths[p].name, e.maxRpm, e.sumRpm / n, e.maxAngle, e.sumAngle / n
+               , static_cast<unsigned long long>(e.maxUlpRpm), e.sumUlpRpm / n
+               , static_cast<unsigned long long>(e.maxUlpAngle), e.sumUlpAngle / n
+               , static_cast<unsigned long long>(e.feasibilityMismatches)
+               , bPathPass ? "ok" : "OVER BUDGET");
+    }
+
+    return bPass ? 0 : 1;
+}
@@ -0,0 +1,193 @@
+#include "AimPolicy.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+using namespace std;
+
+namespace
+{
+    constexpr double c_unreachableMargin = -1.0e3;
+
+    /// Axis aligned box in (targetDist, heightAboveHub) [m]
+    struct SearchBox
+    {
+        double x0, x1, y0, y1;
+        double center;      //!< Worst case margin at the box center
+        double bound;       //!< Upper bound on the worst case margin anywhere in the box
+
+        bool operator<(const SearchBox& o) const { return bound < o.bound; }
+    };
+
+    double Margin(const ShooterConfig& config, const AimSearchOptions& options, double distance, double x, double y)
+    {
+        return WorstCaseMargin(config, options, meter_t(distance), meter_t(x), meter_t(y)).value();
+    }
+
+    AimPolicyEntry SearchDistance(const ShooterConfig& config, const AimSearchOptions& options, meter_t distance)
+    {
+        const double d = distance.value();
+        const double xMin = options.minTargetDist.value();
+        const double xMax = options.maxTargetDist.value();
+        const double yMin = options.minHeightAboveHub.value();
+        const double yMax = options.maxHeightAboveHub.value();
+
+        // Coarse grid: seeds the incumbent and gives the slope estimate for the bound
+        int n = std::max(options.coarseGrid, 2);
+        double dx = (xMax - xMin) / (n - 1);
+        double dy = (yMax - yMin) / (n - 1);
+        vector<double> grid(n * n);
+        double best = -numeric_limits<double>::infinity();
+        double bestX = xMin, bestY = yMin;
+        for (int j = 0; j < n; j++)
+        {
+            for (int i = 0; i < n; i++)
+            {
+                double x = xMin + i * dx;
+                double y = yMin + j * dy;
+                double m = Margin(config, options, d, x, y);
+                grid[j * n + i] = m;
+                if (m > best)
+                {
+                    best = m;
+                    bestX = x;
+                    bestY = y;
+                }
+            }
+        }
+
+        double slope = 0.0;
+        for (int j = 0; j < n; j++)
+        {
+            for (int i = 0; i < n; i++)
+            {
+                double m = grid[j * n + i];
+                if (m <= c_unreachableMargin)
+                    continue;
+                if (i + 1 < n && grid[j * n + i + 1] > c_unreachableMargin)
+                    slope = std::max(slope, fabs(grid[j * n + i + 1] - m) / dx);
+                if (j + 1 < n && grid[(j + 1) * n + i] > c_unreachableMargin)
+                    slope = std::max(slope, fabs(grid[(j + 1) * n + i] - m) / dy);
+            }
+        }
+        double lipschitz = std::max(slope * options.lipschitzSafety, 1e-6);
+
+        auto makeBox = [&](double x0, double x1, double y0, double y1)
+        {
+            SearchBox b{x0, x1, y0, y1, 0.0, 0.0};
+            double cx = 0.5 * (x0 + x1);
+            double cy = 0.5 * (y0 + y1);
+            b.center = Margin(config, options, d, cx, cy);
+            b.bound = b.center + lipschitz * 0.5 * hypot(x1 - x0, y1 - y0);
+            if (b.center > best)
+            {
+                best = b.center;
+                bestX = cx;
+                bestY = cy;
+            }
+            return b;
+        };
+
+        // Best first branch and bound, a box is dropped once its bound cannot beat the incumbent
+        priority_queue<SearchBox> open;
+        open.push(makeBox(xMin, xMax, yMin, yMax));
+        double resolution = options.resolution.value();
+        while (!open.empty())
+        {
+            SearchBox b = open.top();
+            open.pop();
+            if (b.bound <= best)
+                break;      // Best first, so nothing left in the queue can improve either
+            if (b.x1 - b.x0 < resolution && b.y1 - b.y0 < resolution)
+                continue;
+
+            double mx = 0.5 * (b.x0 + b.x1);
+            double my = 0.5 * (b.y0 + b.y1);
+            for (const SearchBox& child : { makeBox(b.x0, mx, b.y0, my), makeBox(mx, b.x1, b.y0, my)
+                                          , makeBox(b.x0, mx, my, b.y1), makeBox(mx, b.x1, my, b.y1) })
+            {
+                if (child.bound > best)
+                    open.push(child);
+            }
+        }
+
+        AimPolicyEntry e;
+        e.distance = distance;
+        e.targetDist = meter_t(bestX);
+        e.heightAboveHub = meter_t(bestY);
+        e.worstMargin = meter_t(best);
+        return e;
+    }
+}
+
+meter_t WorstCaseMargin(const ShooterConfig& config
+                      , const AimSearchOptions& options
+                      , meter_t distance
+                      , meter_t targetDist
+                      , meter_t heightAboveHub)
+{
+    // Margins move monotonically with each error, so the corners and nominal cover the box
+    double worst = numeric_limits<double>::infinity();
+    for (int visionSign = -1; visionSign <= 1; visionSign++)
+    {
+        ShotSolution s = SolveShot(config, distance + visionSign * options.visionError, targetDist, heightAboveHub, options.targetHeight);
+        if (!isfinite(s.rpm.value()))
+            return meter_t(c_unreachableMargin);
+
+        for (int rpmSign = -1; rpmSign <= 1; rpmSign++)
+        {
+            meters_per_second_t vel = config.RpmToExitVel(s.rpm + rpmSign * options.rpmError);
+            ShotOutcome o = EvaluateShotOutcome(config.launchHeight.value(), distance.value(), radian_t(s.angleInit).value(), vel.value());
+            double m = o.bReaches ? std::min(o.frontMargin, o.backMargin) : c_unreachableMargin;
+            worst = std::min(worst, m);
+        }
+    }
+    return meter_t(worst);
+}
+
+AimPolicy OptimizeAimPolicy(const ShooterConfig& config, const vector<meter_t>& distances, const AimSearchOptions& options)
+{
+    AimPolicy policy;
+    policy.targetHeight = options.targetHeight;
+    policy.entries.resize(distances.size());
+
+    ParallelFor(distances.size(), options.threads, [&](size_t begin, size_t end, unsigned)
+    {
+        for (size_t i = begin; i < end; i++)
+            policy.entries[i] = SearchDistance(config, options, distances[i]);
+    });
+
+    sort(policy.entries.begin(), policy.entries.end(), [](const AimPolicyEntry& a, const AimPolicyEntry& b) { return a.distance < b.distance; });
+    return policy;
+}
+
+AimPolicyEntry AimPolicy::Lookup(meter_t distance) const
+{
+    AimPolicyEntry e;
+    if (entries.empty() || distance <= entries.front().distance || distance >= entries.back().distance)
+    {
+        if (!entries.empty())
+            e = distance <= entries.front().distance ? entries.front() : entries.back();
+        e.distance = distance;
+        return e;
+    }
+
+    auto hi = lower_bound(entries.begin(), entries.end(), distance, [](const AimPolicyEntry& e, meter_t d) { return e.distance < d; });
+    auto lo = hi - 1;
+    double t = ((distance - lo->distance) / (hi->distance - lo->distance)).value();
+
+    e.distance = distance;
+    e.targetDist = lo->targetDist + t * (hi->targetDist - lo->targetDist);
+    e.heightAboveHub = lo->heightAboveHub + t * (hi->heightAboveHub - lo->heightAboveHub);
+    e.worstMargin = std::min(lo->worstMargin, hi->worstMargin);
+    return e;
+}
+
+ShotSolution SolveShot(const ShooterConfig& config, const AimPolicy& policy, meter_t distance)
+{
+    AimPolicyEntry aim = policy.Lookup(distance);
+    return SolveShot(config, distance, aim.targetDist, aim.heightAboveHub, policy.targetHeight);
+}
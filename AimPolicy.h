@@ -0,0 +1,62 @@
+/// Robustness-optimal aim point selection
+///
+/// Instead of operator-picked targetDist and heightAboveHub (like the linear m*dist+b rule in the
+/// #if 0 sweep in main.cpp), search both per distance for the aim point whose worst case margin
+/// to either rim is largest when the vision distance and flywheel RPM are off by up to a given
+/// error budget. The result is a table SolveShot() can use directly.
+
+#pragma once
+
+#include <vector>
+
+#include "ShotSolver.h"
+
+/// Aim point for one distance
+struct AimPolicyEntry
+{
+    meter_t distance = meter_t(0.0);
+    meter_t targetDist = defaultTargetDist;
+    meter_t heightAboveHub = defaultHeightAboveHub;
+    meter_t worstMargin = meter_t(0.0);     //!< Smallest rim clearance over the error budget, negative means some errors miss
+};
+
+/// Per distance aim table, linearly interpolated between entries and held at the ends
+struct AimPolicy
+{
+    std::vector<AimPolicyEntry> entries;    //!< Sorted by distance
+    meter_t targetHeight = defaultTargetHeight;
+
+    AimPolicyEntry Lookup(meter_t distance) const;
+};
+
+/// Solves a stationary shot with the aim point taken from the policy
+ShotSolution SolveShot(const ShooterConfig& config, const AimPolicy& policy, meter_t distance);
+
+struct AimSearchOptions
+{
+    meter_t visionError = meter_t(0.05);                            //!< +/- distance error budget
+    revolutions_per_minute_t rpmError = revolutions_per_minute_t(50.0);   //!< +/- flywheel error budget
+
+    meter_t minTargetDist = fuelRadius;
+    meter_t maxTargetDist = hubConeDiameter - fuelRadius;
+    meter_t minHeightAboveHub = hubRimHeight + fuelRadius;
+    meter_t maxHeightAboveHub = hubRimHeight + foot_t(3.0);
+    meter_t targetHeight = defaultTargetHeight;
+
+    meter_t resolution = meter_t(0.005);    //!< Boxes smaller than this are not split further
+    int coarseGrid = 8;                     //!< Samples per axis used to seed the search and estimate the Lipschitz bound
+    double lipschitzSafety = 2.0;           //!< Multiplier on the sampled slope so the bound stays an upper bound
+    unsigned threads = 0;                   //!< 0 uses std::thread::hardware_concurrency()
+};
+
+/// Worst case rim margin over the error box for one aim point at the true distance
+meter_t WorstCaseMargin(const ShooterConfig& config
+                      , const AimSearchOptions& options
+                      , meter_t distance
+                      , meter_t targetDist
+                      , meter_t heightAboveHub);
+
+/// Branch-and-bound search for each distance, distances are searched in parallel
+AimPolicy OptimizeAimPolicy(const ShooterConfig& config
+                          , const std::vector<meter_t>& distances
+                          , const AimSearchOptions& options = AimSearchOptions());
@@ -0,0 +1,373 @@
+/// Microbenchmarks for every solver stage, built as ballistics_bench with -DBALLISTICS_BUILD_BENCHMARKS=ON
+///
+/// Results go to ballistics_bench.json (Google Benchmark JSON) unless --benchmark_out is given, so runs
+/// from different releases can be compared with benchmark's compare.py. Batch benchmarks report items
+/// per second, one item being one distance, sample or design.
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "Calculations.h"
+#include "DesignOptimizer.h"
+#include "FeasibleRegion.h"
+#include "FlywheelControl.h"
+#include "MonteCarlo.h"
+#include "RpmWindow.h"
+#include "ShotBatch.h"
+#include "ShotSolver.h"
+#include "Trajectory.h"
+
+using namespace std;
+
+namespace
+{
+    constexpr foot_t c_benchDistance = foot_t(10.0);
+
+    vector<meter_t> Distances(size_t count)
+    {
+        vector<meter_t> distances(count);
+        for (size_t i = 0; i < count; i++)
+            distances[i] = meter_t(1.0) + meter_t(5.0) * (static_cast<double>(i) / count);
+        return distances;
+    }
+
+    /// Calculations with its members set up by one full solve, so the individual stages see real inputs
+    void Prime(Calculations& calc, bool bClampAngle)
+    {
+        calc.SetClampAngleFlag(bClampAngle);
+        // Long enough that the unclamped angle falls outside the default hood limits
+        calc.CalcInitRPMs(bClampAngle ? meter_t(foot_t(20.0)) : meter_t(c_benchDistance), defaultTargetDist, defaultHeightAboveHub, defaultTargetHeight);
+    }
+}
+
+// Calculations stages
+
+static void BM_FitParabolaToThreePoints(benchmark::State& state)
+{
+    Calculations calc;
+    Prime(calc, true);
+    for (auto _ : state)
+    {
+        calc.FitParabolaToThreePoints();
+        benchmark::DoNotOptimize(calc.parabolaFitAcoeff());
+    }
+}
+BENCHMARK(BM_FitParabolaToThreePoints);
+
+static void BM_HubHeightToMaxHeight(benchmark::State& state)
+{
+    Calculations calc;
+    Prime(calc, true);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(calc.HubHeightToMaxHeight());
+}
+BENCHMARK(BM_HubHeightToMaxHeight);
+
+static void BM_CalcInitVel(benchmark::State& state)
+{
+    const bool bClampAngle = state.range(0) != 0;
+    Calculations calc;
+    Prime(calc, bClampAngle);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(calc.CalcInitVel());
+    state.SetLabel(bClampAngle ? "clamped" : "unclamped");
+}
+BENCHMARK(BM_CalcInitVel)->Arg(0)->Arg(1);
+
+static void BM_CalcInitRPMs(benchmark::State& state)
+{
+    Calculations calc;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(calc.CalcInitRPMs(c_benchDistance, defaultTargetDist, defaultHeightAboveHub, defaultTargetHeight));
+}
+BENCHMARK(BM_CalcInitRPMs);
+
+/// calc() as QML calls it, with a receiver on the change signal like the bound properties
+static void BM_CalcWithSignal(benchmark::State& state)
+{
+    Calculations calc;
+    int notified = 0;
+    QObject::connect(&calc, &Calculations::inputsAndOutputsChanged, [&notified]() { notified++; });
+    for (auto _ : state)
+        benchmark::DoNotOptimize(calc.calc(meter_t(c_benchDistance).value(), meter_t(defaultTargetDist).value(), meter_t(defaultHeightAboveHub).value(), meter_t(defaultTargetHeight).value()));
+    benchmark::DoNotOptimize(notified);
+}
+BENCHMARK(BM_CalcWithSignal);
+
+static void BM_CsvHeader(benchmark::State& state)
+{
+    Calculations calc;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(calc.GetCsvHeader());
+        benchmark::DoNotOptimize(calc.GetCsvHeader2());
+    }
+}
+BENCHMARK(BM_CsvHeader);
+
+static void BM_CsvDataRow(benchmark::State& state)
+{
+    Calculations calc;
+    Prime(calc, true);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(calc.GetCsvDataRow());
+}
+BENCHMARK(BM_CsvDataRow);
+
+static void BM_CsvDataRow2(benchmark::State& state)
+{
+    Calculations calc;
+    Prime(calc, true);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(calc.GetCsvDataRow2());
+}
+BENCHMARK(BM_CsvDataRow2);
+
+static void BM_WriteCsvDataRow2(benchmark::State& state)
+{
+    Calculations calc;
+    Prime(calc, true);
+    vector<char> storage(1 << 16);
+    TextBuffer out(storage.data(), storage.size());
+    for (auto _ : state)
+    {
+        if (out.Size() + 256 > out.Capacity())
+            out.Clear();
+        calc.WriteCsvDataRow2(out);
+        out.Append('\n');
+    }
+    benchmark::DoNotOptimize(storage.data());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_WriteCsvDataRow2);
+
+// Stateless solvers
+
+static void BM_SolveShot(benchmark::State& state)
+{
+    ShooterConfig config;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(SolveShot(config, c_benchDistance, defaultTargetDist, defaultHeightAboveHub, defaultTargetHeight));
+}
+BENCHMARK(BM_SolveShot);
+
+static void BM_SolveShotSensitivitiesBatch(benchmark::State& state)
+{
+    ShooterConfig config;
+    vector<ShotInputs> inputs(state.range(0));
+    vector<meter_t> distances = Distances(inputs.size());
+    for (size_t i = 0; i < inputs.size(); i++)
+        inputs[i].distance = distances[i];
+    vector<ShotSensitivities> results;
+    for (auto _ : state)
+    {
+        SolveShotSensitivitiesBatch(config, inputs, results);
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.SetItemsProcessed(state.iterations() * inputs.size());
+}
+BENCHMARK(BM_SolveShotSensitivitiesBatch)->Arg(1024);
+
+static void BM_SolveShotBatch(benchmark::State& state, bool bFast)
+{
+    ShooterConfig config;
+    ShotBatchInputs inputs;
+    for (meter_t distance : Distances(state.range(0)))
+    {
+        ShotInputs in;
+        in.distance = distance;
+        inputs.Add(in);
+    }
+    ShotBatchResults results;
+    for (auto _ : state)
+    {
+        if (bFast)
+            SolveShotBatchFast(config, inputs, results);
+        else
+            SolveShotBatch(config, inputs, results);
+        benchmark::DoNotOptimize(results.rpm.data());
+    }
+    state.SetItemsProcessed(state.iterations() * inputs.Size());
+}
+BENCHMARK_CAPTURE(BM_SolveShotBatch, double, false)->Arg(1024)->Arg(100000);
+BENCHMARK_CAPTURE(BM_SolveShotBatch, float, true)->Arg(1024)->Arg(100000);
+
+static void BM_SolveShotEnclosure(benchmark::State& state)
+{
+    ShooterConfig config;
+    ShotInputBox box;
+    box.distance = UnitInterval<meter_t>::Around(meter_t(c_benchDistance), meter_t(0.05));
+    box.heightAboveHub = UnitInterval<meter_t>::Around(meter_t(defaultHeightAboveHub), meter_t(0.02));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(SolveShotEnclosure(config, box, static_cast<int>(state.range(0))));
+}
+BENCHMARK(BM_SolveShotEnclosure)->Arg(1)->Arg(8);
+
+static void BM_SolveFixedHoodBatch(benchmark::State& state)
+{
+    ShooterConfig config;
+    vector<meter_t> distances = Distances(state.range(0));
+    vector<FixedHoodSolution> results;
+    for (auto _ : state)
+    {
+        SolveFixedHoodBatch(config, degree_t(45.0), distances, defaultTargetDist, defaultTargetHeight, results);
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.SetItemsProcessed(state.iterations() * distances.size());
+}
+BENCHMARK(BM_SolveFixedHoodBatch)->Arg(1024);
+
+static void BM_SolveFixedRpmBatch(benchmark::State& state)
+{
+    ShooterConfig config;
+    vector<meter_t> distances = Distances(state.range(0));
+    vector<FixedRpmSolution> results;
+    for (auto _ : state)
+    {
+        SolveFixedRpmBatch(config, revolutions_per_minute_t(4000.0), distances, defaultTargetDist, defaultTargetHeight, results);
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.SetItemsProcessed(state.iterations() * distances.size());
+}
+BENCHMARK(BM_SolveFixedRpmBatch)->Arg(1024);
+
+static void BM_SolveRpmWindowBatch(benchmark::State& state)
+{
+    ShooterConfig config;
+    vector<meter_t> distances = Distances(state.range(0));
+    vector<RpmWindow> results;
+    for (auto _ : state)
+    {
+        SolveRpmWindowBatch(config, distances, defaultTargetDist, defaultHeightAboveHub, defaultTargetHeight, results);
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.SetItemsProcessed(state.iterations() * distances.size());
+}
+BENCHMARK(BM_SolveRpmWindowBatch)->Arg(1024);
+
+/// The branch free outcome test the Monte Carlo and window solvers are built on
+static void BM_EvaluateShotOutcome(benchmark::State& state)
+{
+    const size_t count = state.range(0);
+    vector<double> angle(count), vel(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        angle[i] = 0.6 + 0.4 * i / count;
+        vel[i] = 7.0 + 3.0 * i / count;
+    }
+    const double h0 = meter_t(robotHeight).value();
+    const double dist = meter_t(c_benchDistance).value();
+    for (auto _ : state)
+    {
+        int hits = 0;
+        for (size_t i = 0; i < count; i++)
+            hits += EvaluateShotOutcome(h0, dist, angle[i], vel[i]).bHit;
+        benchmark::DoNotOptimize(hits);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_EvaluateShotOutcome)->Arg(4096);
+
+static void BM_RunShotMonteCarlo(benchmark::State& state)
+{
+    ShooterConfig config;
+    MonteCarloOptions options;
+    options.samples = state.range(0);
+    options.threads = 1;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(RunShotMonteCarlo(config, options));
+    state.SetItemsProcessed(state.iterations() * options.samples);
+}
+BENCHMARK(BM_RunShotMonteCarlo)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void BM_SimulateTrajectoryBatch(benchmark::State& state)
+{
+    vector<LaunchConditions<double>> launches(state.range(0));
+    for (size_t i = 0; i < launches.size(); i++)
+        launches[i] = LaunchConditions<double>{7.0 + 3.0 * i / launches.size(), 0.9, 1.0};
+    vector<TrajectoryResult<double>> results;
+    for (auto _ : state)
+    {
+        SimulateTrajectoryBatch(launches, 0.47, 0.0, results);
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.SetItemsProcessed(state.iterations() * launches.size());
+}
+BENCHMARK(BM_SimulateTrajectoryBatch)->Arg(256)->Unit(benchmark::kMillisecond);
+
+static void BM_TraceFeasibleRegion(benchmark::State& state)
+{
+    ShooterConfig config;
+    FeasibleRegionOptions options;
+    options.threads = 1;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(TraceFeasibleRegion(config, c_benchDistance, options));
+}
+BENCHMARK(BM_TraceFeasibleRegion)->Unit(benchmark::kMillisecond);
+
+static void BM_SimulateFlywheelControlBatch(benchmark::State& state)
+{
+    ShooterConfig config;
+    FlywheelPlant plant;
+    vector<FlywheelGains> gains(state.range(0));
+    for (size_t i = 0; i < gains.size(); i++)
+        gains[i].kP = 0.001 + 0.0001 * i;
+    vector<revolutions_per_minute_t> targets = ShotRpmTargets(config, Distances(8));
+    ControlSimOptions options;
+    options.threads = 1;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(SimulateFlywheelControlBatch(config, plant, gains, targets, options));
+    state.SetItemsProcessed(state.iterations() * gains.size() * targets.size());
+}
+BENCHMARK(BM_SimulateFlywheelControlBatch)->Arg(64)->Unit(benchmark::kMillisecond);
+
+static void BM_OptimizeDesign(benchmark::State& state)
+{
+    DesignSpace space;
+    for (int i = 0; i < state.range(0); i++)
+    {
+        space.flywheelMasses.push_back(kilogram_t(0.2 + 0.05 * i));
+        space.flywheelRadii.push_back(meter_t(0.03 + 0.002 * i));
+    }
+    for (int a = 15; a <= 45; a += 5)
+        space.minAngles.push_back(degree_t(a));
+    for (int a = 50; a <= 80; a += 5)
+        space.maxAngles.push_back(degree_t(a));
+    space.distances = Distances(16);
+    space.threads = 1;
+    size_t designs = 0;
+    for (auto _ : state)
+    {
+        DesignSearchResult result = OptimizeDesign(space);
+        designs = result.designsEvaluated;
+        benchmark::DoNotOptimize(result.paretoFront.data());
+    }
+    state.SetItemsProcessed(state.iterations() * designs);
+}
+BENCHMARK(BM_OptimizeDesign)->Arg(32)->Unit(benchmark::kMillisecond);
+
+/// BENCHMARK_MAIN() with JSON output to a file by default
+int main(int argc, char** argv)
+{
+    vector<char*> args(argv, argv + argc);
+    string out = "--benchmark_out=ballistics_bench.json";
+    string format = "--benchmark_out_format=json";
+    bool bHasOut = false;
+    for (int i = 1; i < argc; i++)
+        bHasOut = bHasOut || string(argv[i]).rfind("--benchmark_out=", 0) == 0;
+    if (!bHasOut)
+    {
+        args.push_back(out.data());
+        args.push_back(format.data());
+    }
+
+    int count = static_cast<int>(args.size());
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data()))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,61 @@
+/// Physical constants shared by the ballistics solver and the trajectory models
+
+#pragma once
+
+#include "units/units.h"
+using namespace units::acceleration;
+using namespace units::length;
+using namespace units::mass;
+using namespace units::time;
+using namespace units::velocity;
+using namespace units::angle;
+using namespace units::angular_velocity;
+using namespace units::dimensionless;
+using namespace units;
+
+//using moment_of_inertia_t = units::compound_unit<kilogram, squared<meters>>;
+
+/// Ballistics/Physics constants
+constexpr auto gravity = meters_per_second_squared_t(9.81);
+//constexpr kilogram_t flywheelMass = pound_t(2.8);
+constexpr kilogram_t c_flywheelMass = pound_t(1.5);
+//constexpr kilogram_t flywheelMass = pound_t(3.0);
+
+constexpr meter_t c_flywheelRadius = inch_t(2.0);
+constexpr scalar_t flywheelRotInertiaFrac = 1.0 / 2.0;  // 1/2 Mr^2 solid cylinder
+// Other flywheels: build a FlywheelGeometry (FlywheelInertia.h) and use ShooterConfig::SetFlywheel(), e.g. c_sdsHollowFlywheel
+constexpr auto c_flywheelRotInertia = flywheelRotInertiaFrac * c_flywheelMass * c_flywheelRadius * c_flywheelRadius;
+
+// 2022 constexpr kilogram_t cargoMass = ounce_t(9.5);
+constexpr kilogram_t fuelMass = pound_t(0.5);
+constexpr meter_t fuelRadius = inch_t(5.91 / 2);
+//constexpr scalar_t fuelRotInertiaFrac = 2.0 / 3.0;  // 2/3 Mr^2 hollow sphere
+constexpr scalar_t fuelRotInertiaFrac = 2.0 / 5.0;  // 2/5 Mr^2 solid sphere
+constexpr auto fuelRotInertia = fuelRotInertiaFrac * fuelMass * fuelRadius * fuelRadius;
+
+constexpr auto c_massRatio = c_flywheelMass / fuelMass;
+//constexpr auto rotInertiaRatio = c_flywheelRotInertia / fuelRotInertia;
+
+constexpr degree_t c_minAngle = degree_t(20.0);
+constexpr degree_t c_maxAngle = degree_t(65.0);
+
+//constexpr foot_t robotHeight = foot_t(3.0);
+constexpr foot_t robotHeight = inch_t(30.0);            // Height of center of fuel at launch
+constexpr foot_t defaultTargetDist = foot_t(2.5);       // Upper hub cone was 4 ft across (1.2192 meters); this is the offset into the cone from the rim
+//constexpr foot_t defaultTargetHeight = foot_t(8.67);
+//2022 constexpr foot_t defaultTargetHeight = inch_t(80.0);    // Upper hub went from 5 ft 6 in to 8 ft 8 in (66 to 104 inches); target height should bounded by this range
+constexpr foot_t defaultTargetHeight = inch_t(72.0 - 4.0);
+constexpr foot_t defaultHeightAboveHub = inch_t(72.0) + inch_t(6.0);   // Hub was 8 ft 8 inches in 2022, this represents 6.36 inches above the rim of the upper hub
+constexpr foot_t hubRimHeight = inch_t(72.0);           // Height of the upper hub cone rim
+constexpr meter_t hubConeDiameter = inch_t(42.0);       // Upper hub cone is ~42 inches across (hex shape), matches Main.qml
+
+constexpr auto airDensity = units::density::kilograms_per_cubic_meter_t(1.225);  // Sea level, 15 C
+constexpr auto fuelCrossSection = 3.14159265358979 * fuelRadius * fuelRadius;
+
+/// Ratio of flywheel surface speed to fuel exit velocity for a single flywheel against a fixed hood
+/// See Calculations::CalcInitRPMs() for the references this comes from
+/// \param inertiaFrac	Flywheel inertia over M R^2, see FlywheelGeometry::InertiaFraction()
+constexpr double FlywheelSpeedFactor(double massRatio, double inertiaFrac = flywheelRotInertiaFrac.value())
+{
+    return 2.0 + (fuelRotInertiaFrac.value() + 1.0) / (inertiaFrac * massRatio);
+}
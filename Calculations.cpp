@@ -1,15 +1,61 @@
 #include "Calculations.h"
+#include "StageTrace.h"
+#include <QPointF>
 
 #include <algorithm>
-#ifdef CCP20
-#include <format>
-#endif
+#include <chrono>
+#include <cmath>
+#include <fstream>
 
 using namespace units::math;
 using namespace units;
 using namespace std;
 
+namespace
+{
+    std::string Label(const char* name, const char* unit)
+    {
+        return std::string(name) + " [" + unit + "]";
+    }
+
+    /// Columns of GetCsvDataRow() and the precisions the sweep tables have always used
+    CsvFormat CsvRowFormat()
+    {
+        const char* ft = foot_t(0.0).abbreviation();
+        return CsvFormat({
+            { Label("Dist to Front of Hub", ft), 2 },
+            { Label("Dist from Front of Hub", ft), 2 },
+            { Label("Flywheel", revolutions_per_minute_t(0.0).abbreviation()), 1 },
+            { Label("angleInit", degree_t(0.0).abbreviation()), 1 },
+            { Label("landingAngle", degree_t(0.0).abbreviation()), 1 },
+            { Label("timeTotal", second_t(0.0).abbreviation()), 1 },
+            { Label("heightAboveHub", ft), 1 },
+            { Label("heightTarget", ft), 1 },
+            { Label("heightMax", ft), 1 },
+            { Label("velInit", meters_per_second_t(0.0).abbreviation()), 1 },
+        });
+    }
+
+    /// Columns of GetCsvDataRow2()
+    CsvFormat CsvRowFormat2()
+    {
+        const char* ft = foot_t(0.0).abbreviation();
+        return CsvFormat({
+            { Label("Vision Dist to Cemter of Hub", ft), 2 },
+            { Label("Dist to Front of Hub", ft), 2 },
+            { Label("Dist from Front of Hub", ft), 2 },
+            { Label("heightAboveHub", ft), 1 },
+            { Label("heightTarget", ft), 1 },
+            { Label("Flywheel", revolutions_per_minute_t(0.0).abbreviation()), 1 },
+            { Label("angleInit", degree_t(0.0).abbreviation()), 1 },
+            { Label("landingAngle", degree_t(0.0).abbreviation()), 1 },
+        });
+    }
+}
+
 Calculations::Calculations()
+  : m_csvFormat(CsvRowFormat())
+  , m_csvFormat2(CsvRowFormat2())
 {
   m_heightRobot = robotHeight;
   m_heightTarget = defaultTargetHeight;
@@ -18,6 +64,7 @@ Calculations::Calculations()
 // This fits the 3 points to the parabola in order to calculate the max height
 meter_t Calculations::HubHeightToMaxHeight()
 {
+  BALLISTICS_TRACE_SCOPE("HubHeightToMaxHeight");
   auto hTarg = m_heightTarget - m_heightRobot;
   auto dist = m_xInput + m_xTarget;
   auto hAbove = m_heightAboveHub - m_heightRobot;
@@ -42,6 +89,7 @@ meter_t Calculations::HubHeightToMaxHeight()
 
 void Calculations::FitParabolaToThreePoints()
 {
+    BALLISTICS_TRACE_SCOPE("FitParabolaToThreePoints");
     //qDebug("m_xInput %.3f m_xTarget %.3f m_heightAboveHub %.3f m_heightTarget %.3f m_heightRobot %.3f"
     //       , m_xInput.value()
     //       , m_xTarget.value()
@@ -142,6 +190,7 @@ meters_per_second_t Calculations::CalcInitYVel()
 
 meters_per_second_t Calculations::CalcInitVel()
 {
+  BALLISTICS_TRACE_SCOPE("CalcInitVel");
   HubHeightToMaxHeight();
 
   CalcInitYVel();
@@ -162,9 +211,12 @@ meters_per_second_t Calculations::CalcInitVel()
   }
 
   CalcInitVelWithAngle();
+  if (!isfinite(m_velInit.value()))
+    CountSolverEvent(c_statInfeasible);   // totalXDist * tan(angle) fell below the target height, no real velocity
 
   if (bClamped)
   {
+      CountSolverEvent(c_statClamped);
       // If we clamp the angle, we need to recalc the vx and vy as inputs to CalcInitVelWithAngle()
       m_velYInit = m_velInit * math::sin(m_angleInit);
       m_velXInit = m_velInit * math::cos(m_angleInit);
@@ -201,6 +253,7 @@ Q_INVOKABLE double Calculations::calc(double distance
                                     , double heightAboveHub
                                     , double targetHeight)
 {
+    BALLISTICS_TRACE_SCOPE("calc");
     revolutions_per_minute_t revs = CalcInitRPMs(meter_t{distance}
                                                , meter_t{targetDist}
                                                , meter_t{heightAboveHub}
@@ -209,12 +262,48 @@ Q_INVOKABLE double Calculations::calc(double distance
     return revs.value();
 }
 
+Q_INVOKABLE double Calculations::calcWithHeightPolicy(double distance, double targetDist, double targetHeight)
+{
+    meter_t heightAboveHub = m_heightPolicy.IsEmpty() ? m_heightAboveHub : m_heightPolicy.Evaluate(meter_t{distance});
+    return calc(distance, targetDist, heightAboveHub.value(), targetHeight);
+}
+
+Q_INVOKABLE QVariantMap Calculations::feasibleRegion(double distance)
+{
+    FeasibleRegion region = m_feasibleRegions.Get(GetShooterConfig(), meter_t{distance});
+
+    QVariantList polygons;
+    for (const std::vector<RegionPoint>& outline : region.polygons)
+    {
+        QVariantList points;
+        for (const RegionPoint& p : outline)
+            points.append(QPointF(p.rpm.value(), p.angle.value()));
+        polygons.append(QVariant(points));
+    }
+
+    QVariantMap result;
+    result["minRpm"] = region.minRpm.value();
+    result["maxRpm"] = region.maxRpm.value();
+    result["minAngle"] = region.minAngle.value();
+    result["maxAngle"] = region.maxAngle.value();
+    result["area"] = region.area;
+    result["polygons"] = polygons;
+    return result;
+}
+
+revolutions_per_minute_t Calculations::CalcInitRPMs(meter_t distance, meter_t targetDist, const HeightAboveHubPolicy& policy, meter_t targetHeight)
+{
+    return CalcInitRPMs(distance, targetDist, policy.Evaluate(distance), targetHeight);
+}
+
 revolutions_per_minute_t Calculations::CalcInitRPMs(  meter_t distance        // Floor distance to "front" rim of cone
                                                     , meter_t targetDist      // Target distance within cone from rim
                                                     , meter_t heightAboveHub  // How far above Hub to place the shot (includes height of hub)
                                                     , meter_t targetHeight    // Height at end point within cone (includes height where the hub code starts)
                                                    )
 {
+  BALLISTICS_TRACE_SCOPE("CalcInitRPMs");
+  auto solveBegin = chrono::steady_clock::now();
   m_xInput = distance;
   m_xTarget = targetDist;
   m_heightTarget = targetHeight;
@@ -241,10 +330,16 @@ revolutions_per_minute_t Calculations::CalcInitRPMs(  meter_t distance        //
   //
   // New in 2026 https://docs.carlmontrobotics.org/jupyter_notebooks/files/FlywheelShooter.html
   // Points to this "paper" https://docs.carlmontrobotics.org/jupyter_notebooks/files/FlywheelShooter.html
-  m_rotVelInit = radian_t(1.0) * m_velInit / m_flywheelRadius * (2.0 + (fuelRotInertiaFrac + 1.0) / (flywheelRotInertiaFrac * m_massRatio));
+  m_rotVelInit = radian_t(1.0) * m_velInit / m_flywheelRadius * DefaultShooterModel::SpeedFactor(m_massRatio.value(), m_flywheelInertiaFrac.value());
   m_rpmInit = m_rotVelInit;
 
-  emit inputsAndOutputsChanged();
+  CountSolverEvent(c_statSolves);
+  RecordSolveLatency(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - solveBegin).count());
+
+  {
+    BALLISTICS_TRACE_SCOPE("inputsAndOutputsChanged");
+    emit inputsAndOutputsChanged();
+  }
 
   return m_rpmInit;
 }
@@ -263,430 +358,152 @@ revolutions_per_minute_t Calculations::CalcInitRPMs(  meter_t distance        //
 
 std::string Calculations::GetIntermediateResults()
 {
-    std::string out;
-
-    out += "  m_timeOne ";
-    out += std::to_string(m_timeOne.value());
-    out += " ";
-    out += m_timeOne.abbreviation();
-
-    out += "\n  m_timeTwo ";
-    out += std::to_string(m_timeTwo.value());
-    out += " ";
-    out += m_timeTwo.abbreviation();
-
-    out += "\n  m_timeTotal ";
-    out += std::to_string(m_timeTotal.value());
-    out += " ";
-    out += m_timeTotal.abbreviation();
-
-    out += "\n  m_heightAboveHub ";
-    out += std::to_string(m_heightAboveHub.convert<foot>().value());
-    out += " ";
-    out += m_heightAboveHub.convert<foot>().abbreviation();
-
-    out += "\n  m_heightRobot ";
-    out += std::to_string(m_heightRobot.convert<foot>().value());
-    out += " ";
-    out += m_heightRobot.convert<foot>().abbreviation();
-
-    out += "\n  m_heightTarget ";
-    out += std::to_string(m_heightTarget.convert<foot>().value());
-    out += " ";
-    out += m_heightTarget.convert<foot>().abbreviation();
-
-    out += "\n  m_heightMax ";
-    out += std::to_string(m_heightMax.convert<foot>().value());
-    out += " ";
-    out += m_heightMax.convert<foot>().abbreviation();
-
-    out += "\n  m_xInput ";
-    out += std::to_string(m_xInput.convert<foot>().value());
-    out += " ";
-    out += m_xInput.convert<foot>().abbreviation();
-
-    out += "\n  m_xTarget ";
-    out += std::to_string(m_xTarget.convert<foot>().value());
-    out += " ";
-    out += m_xTarget.convert<foot>().abbreviation();
-
-    out += "\n  m_velXInit ";
-    out += std::to_string(m_velXInit.value());
-    out += " ";
-    out += m_velXInit.abbreviation();
-
-    out += "\n  m_velYInit ";
-    out += std::to_string(m_velYInit.value());
-    out += " ";
-    out += m_velYInit.abbreviation();
-
-    out += "\n  m_velInit ";
-    out += std::to_string(m_velInit.value());
-    out += " ";
-    out += m_velInit.abbreviation();
-
-    out += "\n  m_angleInit ";
-    out += std::to_string(m_angleInit.value());
-    out += " ";
-    out += m_angleInit.abbreviation();
-
-    out += "\n  m_rotVelInit ";
-    out += std::to_string(m_rotVelInit.value());
-    out += " ";
-    out += m_rotVelInit.abbreviation();
-
-    out += "\n  m_rpmInit ";
-    out += std::to_string(m_rpmInit.value());
-    out += " ";
-    out += m_rpmInit.abbreviation();
-
-    return out;
+    std::array<char, 1024> storage;
+    TextBuffer out(storage);
+
+    auto field = [&out](const char* name, double value, const char* unit)
+    {
+        if (out.Size() > 0)
+            out.Append('\n');
+        out.Append("  ");
+        out.Append(name);
+        out.Append(' ');
+        out.AppendFixed(value, 6);
+        out.Append(' ');
+        out.Append(unit);
+    };
+
+    field("m_timeOne", m_timeOne.value(), m_timeOne.abbreviation());
+    field("m_timeTwo", m_timeTwo.value(), m_timeTwo.abbreviation());
+    field("m_timeTotal", m_timeTotal.value(), m_timeTotal.abbreviation());
+    field("m_heightAboveHub", m_heightAboveHub.convert<foot>().value(), m_heightAboveHub.convert<foot>().abbreviation());
+    field("m_heightRobot", m_heightRobot.convert<foot>().value(), m_heightRobot.convert<foot>().abbreviation());
+    field("m_heightTarget", m_heightTarget.convert<foot>().value(), m_heightTarget.convert<foot>().abbreviation());
+    field("m_heightMax", m_heightMax.convert<foot>().value(), m_heightMax.convert<foot>().abbreviation());
+    field("m_xInput", m_xInput.convert<foot>().value(), m_xInput.convert<foot>().abbreviation());
+    field("m_xTarget", m_xTarget.convert<foot>().value(), m_xTarget.convert<foot>().abbreviation());
+    field("m_velXInit", m_velXInit.value(), m_velXInit.abbreviation());
+    field("m_velYInit", m_velYInit.value(), m_velYInit.abbreviation());
+    field("m_velInit", m_velInit.value(), m_velInit.abbreviation());
+    field("m_angleInit", m_angleInit.value(), m_angleInit.abbreviation());
+    field("m_rotVelInit", m_rotVelInit.value(), m_rotVelInit.abbreviation());
+    field("m_rpmInit", m_rpmInit.value(), m_rpmInit.abbreviation());
+
+    return out.ToString();
 }
 
-#ifdef CPP20
 std::string Calculations::GetCsvHeader()
 {
-    std::string out;
-
-    // Inputs
-    out += "Dist to Front of Hub [";
-    out += m_xInput.convert<foot>().abbreviation();
-    out += "],";
-
-    out += "Dist from Front of Hub [";
-    out += m_xTarget.convert<foot>().abbreviation();
-    out += "],";
-
-    // Outputs
-    out += "Flywheel [";
-    out += m_rpmInit.abbreviation();
-    out += "] HAH ";
-    //out += std::to_string(m_heightAboveHub.convert<foot>().value());
-    out += std::format("{:.1f}", m_heightAboveHub.convert<foot>().value());
-    out += ",";
-
-    out += "angleInit [";
-    out += m_angleInit.abbreviation();
-    out += "] HAH ";
-    out += std::format("{:.1f}", m_angleInit.value());
-    out += ",";
-
-    out += "landingAngle [";
-    out += m_landingAngle.abbreviation();
-    out += "] HAH ";
-    out += std::format("{:.1f}", m_heightAboveHub.convert<foot>()
-        .value());
-    out += ",";
-
-    // Intermediate
-    out += "timeTotal [";
-    out += m_timeTotal.abbreviation();
-    out += "],";
-
-    out += "heightAboveHub [";
-    out += m_heightAboveHub.convert<foot>().abbreviation();
-    out += "],";
-
-    out += "heightTarget [";
-    out += m_heightTarget.convert<foot>().abbreviation();
-    out += "],";
-
-    out += "heightMax [";
-    out += m_heightMax.convert<foot>().abbreviation();
-    out += "],";
-
-    out += "velInit [";
-    out += m_velInit.abbreviation();
-    out += "]";
-
-    return out;
+    // The output columns are labeled with the height above hub and launch angle the table was made with
+    const double hah = m_heightAboveHub.convert<foot>().value();
+    const double labelValues[] = { NAN, NAN, hah, m_angleInit.value(), hah, NAN, NAN, NAN, NAN, NAN };
+    static_assert(sizeof(labelValues) / sizeof(labelValues[0]) == c_csvRowColumns, "one label value per column");
+
+    std::array<char, 512> storage;
+    TextBuffer out(storage);
+    for (size_t i = 0; i < m_csvFormat.Columns(); i++)
+    {
+        if (i > 0)
+            out.Append(',');
+        out.Append(m_csvFormat.Column(i).header);
+        if (!std::isnan(labelValues[i]))
+        {
+            out.Append(" HAH ");
+            out.AppendFixed(labelValues[i], 1);
+        }
+    }
+    return out.ToString();
 }
 
 std::string Calculations::GetCsvHeader2()
 {
-    std::string out;
-
-    // Inputs
-    out += "Vision Dist to Cemter of Hub [";
-    out += m_xInput.convert<foot>().abbreviation();
-    out += "],";
-
-    out += "Dist to Front of Hub [";
-    out += m_xInput.convert<foot>().abbreviation();
-    out += "],";
-
-    out += "Dist from Front of Hub [";
-    out += m_xTarget.convert<foot>().abbreviation();
-    out += "],";
-
-    out += "heightAboveHub [";
-    out += m_heightAboveHub.convert<foot>().abbreviation();
-    out += "],";
-
-    out += "heightTarget [";
-    out += m_heightTarget.convert<foot>().abbreviation();
-    out += "],";
-
-    // Outputs
-    out += "Flywheel [";
-    out += m_rpmInit.abbreviation();
-    out += "],";
-
-    out += "angleInit [";
-    out += m_angleInit.abbreviation();
-    out += "],";
-
-    out += "landingAngle [";
-    out += m_landingAngle.abbreviation();
-    out += "]";
-
-    return out;
+    return m_csvFormat2.Header();
 }
 
 std::string Calculations::GetCsvDataRow()
 {
-    std::string out;
-
-    // Inputs
-    //out += std::to_string(m_xInput.convert<foot>().value());
-    out += std::format("{:.2f}", m_xInput.convert<foot>().value());
-    out += ",";
-
-    //out += std::to_string(m_xTarget.convert<foot>().value());
-    out += std::format("{:.2f}", m_xTarget.convert<foot>().value());
-    out += ",";
-
-    // Outputs
-    //out += std::to_string(m_rpmInit.value());
-    out += std::format("{:.1f}", m_rpmInit.value());
-    out += ",";
-
-    //out += std::to_string(m_angleInit.value());
-    out += std::format("{:.1f}", m_angleInit.value());
-    out += ",";
-
-    out += std::format("{:.1f}", m_landingAngle.value());
-    out += ",";
-
-    // Intermediate
-    //out += std::to_string(m_timeTotal.value());
-    out += std::format("{:.1f}", m_timeTotal.value());
-    out += ",";
-
-    //out += std::to_string(m_heightAboveHub.convert<foot>().value());
-    out += std::format("{:.1f}", m_heightAboveHub.convert<foot>().value());
-    out += ",";
-
-    out += std::format("{:.1f}", m_heightTarget.convert<foot>().value());
-    out += ",";
-
-    //out += std::to_string(m_heightMax.convert<foot>().value());
-    out += std::format("{:.1f}", m_heightMax.convert<foot>().value());
-    out += ",";
-  
-    //out += std::to_string(m_velInit.value());
-    out += std::format("{:.1f}", m_velInit.value());
-
-    return out;
+    std::array<char, 512> storage;
+    TextBuffer out(storage);
+    WriteCsvDataRow(out);
+    return out.ToString();
 }
 
 std::string Calculations::GetCsvDataRow2()
 {
-    std::string out;
-
-    // Inputs
-    out += std::format("{:.2f}", m_xInput.convert<foot>().value() + m_xTarget.convert<foot>().value());
-    out += ",";
-
-    out += std::format("{:.2f}", m_xInput.convert<foot>().value());
-    out += ",";
-
-    out += std::format("{:.2f}", m_xTarget.convert<foot>().value());
-    out += ",";
-
-    out += std::format("{:.1f}", m_heightAboveHub.convert<foot>().value());
-    out += ",";
-
-    out += std::format("{:.1f}", m_heightTarget.convert<foot>().value());
-    out += ",";
-
-    // Outputs
-    out += std::format("{:.1f}", m_rpmInit.value());
-    out += ",";
-
-    out += std::format("{:.1f}", m_angleInit.value());
-    out += ",";
-
-    out += std::format("{:.1f}", m_landingAngle.value());
-
-    return out;
+    std::array<char, 512> storage;
+    TextBuffer out(storage);
+    WriteCsvDataRow2(out);
+    return out.ToString();
 }
-#else
-std::string Calculations::GetCsvHeader()
+
+void Calculations::WriteCsvDataRow(TextBuffer& out) const
 {
-    std::string out;
-
-    // Inputs
-    out += "Dist to Front of Hub [";
-    out += m_xInput.convert<foot>().abbreviation();
-    out += "],";
-
-    out += "Dist from Front of Hub [";
-    out += m_xTarget.convert<foot>().abbreviation();
-    out += "],";
-
-    // Outputs
-    out += "Flywheel [";
-    out += m_rpmInit.abbreviation();
-    out += "] HAH ";
-    out += std::to_string(m_heightAboveHub.convert<foot>().value());
-    out += ",";
-
-    out += "angleInit [";
-    out += m_angleInit.abbreviation();
-    out += "] HAH ";
-    out += std::to_string(m_angleInit.value());
-    out += ",";
-
-    out += "landingAngle [";
-    out += m_landingAngle.abbreviation();
-    out += "] HAH ";
-    out += std::to_string(m_heightAboveHub.convert<foot>().value());
-    out += ",";
-
-    // Intermediate
-    out += "timeTotal [";
-    out += m_timeTotal.abbreviation();
-    out += "],";
-
-    out += "heightAboveHub [";
-    out += m_heightAboveHub.convert<foot>().abbreviation();
-    out += "],";
-
-    out += "heightTarget [";
-    out += m_heightTarget.convert<foot>().abbreviation();
-    out += "],";
-
-    out += "heightMax [";
-    out += m_heightMax.convert<foot>().abbreviation();
-    out += "],";
-
-    out += "velInit [";
-    out += m_velInit.abbreviation();
-    out += "]";
-
-    return out;
+    const double values[c_csvRowColumns] =
+    {
+        // Inputs
+        m_xInput.convert<foot>().value(),
+        m_xTarget.convert<foot>().value(),
+        // Outputs
+        m_rpmInit.value(),
+        m_angleInit.value(),
+        m_landingAngle.value(),
+        // Intermediate
+        m_timeTotal.value(),
+        m_heightAboveHub.convert<foot>().value(),
+        m_heightTarget.convert<foot>().value(),
+        m_heightMax.convert<foot>().value(),
+        m_velInit.value()
+    };
+    m_csvFormat.WriteRow(out, values);
 }
 
-std::string Calculations::GetCsvHeader2()
+void Calculations::WriteCsvDataRow2(TextBuffer& out) const
 {
-    std::string out;
-
-    // Inputs
-    out += "Vision Dist to Cemter of Hub [";
-    out += m_xInput.convert<foot>().abbreviation();
-    out += "],";
-
-    out += "Dist to Front of Hub [";
-    out += m_xInput.convert<foot>().abbreviation();
-    out += "],";
-
-    out += "Dist from Front of Hub [";
-    out += m_xTarget.convert<foot>().abbreviation();
-    out += "],";
-
-    out += "heightAboveHub [";
-    out += m_heightAboveHub.convert<foot>().abbreviation();
-    out += "],";
-
-    out += "heightTarget [";
-    out += m_heightTarget.convert<foot>().abbreviation();
-    out += "],";
-
-    // Outputs
-    out += "Flywheel [";
-    out += m_rpmInit.abbreviation();
-    out += "],";
-
-    out += "angleInit [";
-    out += m_angleInit.abbreviation();
-    out += "],";
-
-    out += "landingAngle [";
-    out += m_landingAngle.abbreviation();
-    out += "]";
-
-    return out;
+    const double values[c_csvRow2Columns] =
+    {
+        // Inputs
+        m_xInput.convert<foot>().value() + m_xTarget.convert<foot>().value(),
+        m_xInput.convert<foot>().value(),
+        m_xTarget.convert<foot>().value(),
+        m_heightAboveHub.convert<foot>().value(),
+        m_heightTarget.convert<foot>().value(),
+        // Outputs
+        m_rpmInit.value(),
+        m_angleInit.value(),
+        m_landingAngle.value()
+    };
+    m_csvFormat2.WriteRow(out, values);
 }
 
-std::string Calculations::GetCsvDataRow()
+double Calculations::traceNow() const
 {
-    std::string out;
-
-    // Inputs
-    out += std::to_string(m_xInput.convert<foot>().value());
-    out += ",";
-
-    out += std::to_string(m_xTarget.convert<foot>().value());
-    out += ",";
-
-    // Outputs
-    out += std::to_string(m_rpmInit.value());
-    out += ",";
-
-    out += std::to_string(m_angleInit.value());
-    out += ",";
-
-    out += std::to_string(m_landingAngle.value());
-    out += ",";
-
-    // Intermediate
-    out += std::to_string(m_timeTotal.value());
-    out += ",";
-
-    out += std::to_string(m_heightAboveHub.convert<foot>().value());
-    out += ",";
-
-    out += std::to_string(m_heightTarget.convert<foot>().value());
-    out += ",";
-
-    out += std::to_string(m_heightMax.convert<foot>().value());
-    out += ",";
-  
-    out += std::to_string(m_velInit.value());
-
-    return out;
+    return static_cast<double>(TraceNowNs());
 }
 
-std::string Calculations::GetCsvDataRow2()
+void Calculations::traceStage(const QString& name, double beginNs)
 {
-    std::string out;
-
-    // Inputs
-    out += std::to_string(m_xInput.convert<foot>().value() + m_xTarget.convert<foot>().value());
-    out += ",";
-
-    out += std::to_string(m_xInput.convert<foot>().value());
-    out += ",";
-
-    out += std::to_string(m_xTarget.convert<foot>().value());
-    out += ",";
-
-    out += std::to_string(m_heightAboveHub.convert<foot>().value());
-    out += ",";
-
-    out += std::to_string(m_heightTarget.convert<foot>().value());
-    out += ",";
-
-    // Outputs
-    out += std::to_string(m_rpmInit.value());
-    out += ",";
-
-    out += std::to_string(m_angleInit.value());
-    out += ",";
+    if (c_bTraceEnabled)
+        RecordTraceEvent(TraceStageName(name), static_cast<int64_t>(beginNs), TraceNowNs());
+}
 
-    out += std::to_string(m_landingAngle.value());
+const char* Calculations::TraceStageName(const QString& name)
+{
+    // QML only passes a couple of fixed names, a linear scan beats hashing the string
+    for (const std::pair<QString, const char*>& n : m_traceNames)
+    {
+        if (n.first == name)
+            return n.second;
+    }
+    m_traceNames.emplace_back(name, InternTraceName(name.toStdString()));
+    return m_traceNames.back().second;
+}
 
-    return out;
+bool Calculations::dumpTrace(const QString& path)
+{
+    std::ofstream out(path.toStdString());
+    if (!out)
+        return false;
+    size_t events = ExportChromeTrace(out);
+    qDebug("Wrote %zu trace events to %s", events, path.toStdString().c_str());
+    return out.good();
 }
-#endif
@@ -3,51 +3,18 @@
 #pragma once
 
 #include <QObject>
+#include <QVariant>
 
-#include "units/units.h"
-using namespace units::acceleration;
-using namespace units::length;
-using namespace units::mass;
-using namespace units::time;
-using namespace units::velocity;
-using namespace units::angle;
-using namespace units::angular_velocity;
-using namespace units::dimensionless;
-using namespace units;
-
-//using moment_of_inertia_t = units::compound_unit<kilogram, squared<meters>>;
-
-/// Ballistics/Physics constants
-constexpr auto gravity = meters_per_second_squared_t(9.81);
-//constexpr kilogram_t flywheelMass = pound_t(2.8);
-constexpr kilogram_t c_flywheelMass = pound_t(1.5);
-//constexpr kilogram_t flywheelMass = pound_t(3.0);
-
-constexpr meter_t c_flywheelRadius = inch_t(2.0);
-constexpr scalar_t flywheelRotInertiaFrac = 1.0 / 2.0;  // 1/2 Mr^2 solid cylinder
-//constexpr scalar_t flywheelRotInertiaFrac = 0.6659;  // based on the SDS brass hollow flywheel with MOI 4 [pound][square inches]
-constexpr auto c_flywheelRotInertia = flywheelRotInertiaFrac * c_flywheelMass * c_flywheelRadius * c_flywheelRadius;
-
-// 2022 constexpr kilogram_t cargoMass = ounce_t(9.5);
-constexpr kilogram_t fuelMass = pound_t(0.5);
-constexpr meter_t fuelRadius = inch_t(5.91 / 2);
-//constexpr scalar_t fuelRotInertiaFrac = 2.0 / 3.0;  // 2/3 Mr^2 hollow sphere
-constexpr scalar_t fuelRotInertiaFrac = 2.0 / 5.0;  // 2/5 Mr^2 solid sphere
-constexpr auto fuelRotInertia = fuelRotInertiaFrac * fuelMass * fuelRadius * fuelRadius;
-
-constexpr auto c_massRatio = c_flywheelMass / fuelMass;
-//constexpr auto rotInertiaRatio = c_flywheelRotInertia / fuelRotInertia;
-
-constexpr degree_t c_minAngle = degree_t(20.0);
-constexpr degree_t c_maxAngle = degree_t(65.0);
-
-//constexpr foot_t robotHeight = foot_t(3.0);
-constexpr foot_t robotHeight = inch_t(30.0);            // Height of center of fuel at launch
-constexpr foot_t defaultTargetDist = foot_t(2.5);       // Upper hub cone was 4 ft across (1.2192 meters); this is the offset into the cone from the rim
-//constexpr foot_t defaultTargetHeight = foot_t(8.67);
-//2022 constexpr foot_t defaultTargetHeight = inch_t(80.0);    // Upper hub went from 5 ft 6 in to 8 ft 8 in (66 to 104 inches); target height should bounded by this range
-constexpr foot_t defaultTargetHeight = inch_t(72.0 - 4.0);
-constexpr foot_t defaultHeightAboveHub = inch_t(72.0) + inch_t(6.0);   // Hub was 8 ft 8 inches in 2022, this represents 6.36 inches above the rim of the upper hub
+#include <utility>
+#include <vector>
+
+#include "BallisticsConstants.h"
+#include "CsvFormat.h"
+#include "FeasibleRegion.h"
+#include "FlywheelInertia.h"
+#include "HeightPolicy.h"
+#include "ShotSolver.h"
+#include "SolverStats.h"
 
 class Calculations : public QObject
 {
@@ -66,6 +33,7 @@ class Calculations : public QObject
     Q_PROPERTY(double flywheelRadius        READ flywheelRadius         NOTIFY physicalPropertiesChanged)
     Q_PROPERTY(double minAngle              READ minAngle               NOTIFY physicalPropertiesChanged)
     Q_PROPERTY(double maxAngle              READ maxAngle               NOTIFY physicalPropertiesChanged)
+    Q_PROPERTY(double flywheelInertiaFrac   READ flywheelInertiaFrac    NOTIFY physicalPropertiesChanged)
 
     Q_PROPERTY(double inputDist             READ inputDist              NOTIFY inputsAndOutputsChanged)
     Q_PROPERTY(double inputTargetDist       READ inputTargetDist        NOTIFY inputsAndOutputsChanged)
@@ -82,6 +50,14 @@ class Calculations : public QObject
     Q_PROPERTY(double outputInitAngle       READ outputInitAngle        NOTIFY inputsAndOutputsChanged)
     Q_PROPERTY(double outputLandingAngle    READ outputLandingAngle     NOTIFY inputsAndOutputsChanged)
 
+    Q_PROPERTY(double statSolves            READ statSolves             NOTIFY solverStatsChanged)
+    Q_PROPERTY(double statClampRate         READ statClampRate          NOTIFY solverStatsChanged)
+    Q_PROPERTY(double statInfeasibleRate    READ statInfeasibleRate     NOTIFY solverStatsChanged)
+    Q_PROPERTY(double statCacheHitRate      READ statCacheHitRate       NOTIFY solverStatsChanged)
+    Q_PROPERTY(double statLatencyP50        READ statLatencyP50         NOTIFY solverStatsChanged)
+    Q_PROPERTY(double statLatencyP99        READ statLatencyP99         NOTIFY solverStatsChanged)
+    Q_PROPERTY(double statLatencyMax        READ statLatencyMax         NOTIFY solverStatsChanged)
+
 public:
     Calculations();
 
@@ -97,6 +73,7 @@ public:
     double flywheelRadius() const { return m_flywheelRadius.value(); }
     double minAngle() const { return m_minAngle.value(); }
     double maxAngle() const { return m_maxAngle.value(); }
+    double flywheelInertiaFrac() const { return m_flywheelInertiaFrac.value(); }
 
     double inputDist() const { return m_xInput.value(); }
     double inputTargetDist() const { return m_xTarget.value(); }
@@ -113,6 +90,28 @@ public:
     double outputInitAngle() const { return m_angleInit.value(); }
     double outputLandingAngle() const { return m_landingAngle.value(); }
 
+    // Solver counters as of the last refreshSolverStats(), latencies in [us]
+    double statSolves() const { return static_cast<double>(m_solverStats.Count(c_statSolves)); }
+    double statClampRate() const { return m_solverStats.ClampRate(); }
+    double statInfeasibleRate() const { return m_solverStats.InfeasibleRate(); }
+    double statCacheHitRate() const { return m_solverStats.CacheHitRate(); }
+    double statLatencyP50() const { return m_solverStats.LatencyPercentileNs(0.5) / 1000.0; }
+    double statLatencyP99() const { return m_solverStats.LatencyPercentileNs(0.99) / 1000.0; }
+    double statLatencyMax() const { return m_solverStats.LatencyMaxNs() / 1000.0; }
+
+    /// Takes a new snapshot of the process wide counters (SolverStats.h) for the stat properties
+    Q_INVOKABLE void refreshSolverStats()
+    {
+        m_solverStats = TakeSolverStats();
+        emit solverStatsChanged();
+    }
+
+    Q_INVOKABLE void resetSolverStats()
+    {
+        ResetSolverStats();
+        refreshSolverStats();
+    }
+
     meter_t HubHeightToMaxHeight();
     void FitParabolaToThreePoints();
     second_t CalcTimeOne();
@@ -126,6 +125,8 @@ public:
     /// Call after GetInitVelWithAngle or GetInitRPMS
     degree_t GetInitAngle();
 
+    /// The flywheel mass and radius scale the current flywheel geometry uniformly, which keeps its
+    /// inertia fraction, see setFlywheelPreset()
     Q_INVOKABLE void setPhysicalProperties(double flywheelMass
                                          , double flywheelRadius
                                          , double minAngle
@@ -136,7 +137,25 @@ public:
         m_minAngle = degree_t{minAngle};
         m_maxAngle = degree_t{maxAngle};
 
-        m_massRatio = m_flywheelMass / fuelMass;
+        m_massRatio = m_flywheelMass / DefaultShooterModel::GamePiece::mass;
+    }
+
+    /// Mass, radius and inertia fraction from the flywheel's parts, the hood limits are left alone
+    void SetFlywheelGeometry(const FlywheelGeometry& flywheel)
+    {
+        m_flywheelMass = flywheel.Mass();
+        m_flywheelRadius = flywheel.Radius();
+        m_flywheelInertiaFrac = flywheel.InertiaFraction();
+
+        m_massRatio = m_flywheelMass / DefaultShooterModel::GamePiece::mass;
+    }
+
+    /// SetFlywheelGeometry() from the flywheels in FlywheelInertia.h for the flywheel selector
+    /// \param preset  0 solid cylinder (c_defaultFlywheel), 1 SDS hollow flywheel (c_sdsHollowFlywheel)
+    Q_INVOKABLE void setFlywheelPreset(int preset)
+    {
+        SetFlywheelGeometry(preset == 1 ? c_sdsHollowFlywheel : c_defaultFlywheel);
+        emit physicalPropertiesChanged();
     }
 
     Q_INVOKABLE double calc(double distance
@@ -153,10 +172,40 @@ public:
                                         , meter_t heightAboveHub = defaultHeightAboveHub
                                         , meter_t targetHeight = defaultTargetHeight);        //!< Calculates the RPMs needed to shoot the specified distance
 
+    /// Same, with heightAboveHub taken from the policy at this distance
+    revolutions_per_minute_t CalcInitRPMs(  meter_t distance
+                                        , meter_t targetDist
+                                        , const HeightAboveHubPolicy& policy
+                                        , meter_t targetHeight = defaultTargetHeight);
+
+    /// Uses the policy set with SetHeightAboveHubPolicy(), or the current heightAboveHub if none is set
+    Q_INVOKABLE double calcWithHeightPolicy(double distance
+                                          , double targetDist
+                                          , double targetHeight);
+
+    /// Scoring (RPM, angle) region at the floor distance for the overlay, traced once per distance and cached
+    /// \return Map with minRpm, maxRpm, minAngle, maxAngle, area and polygons (list of lists of QPointF(rpm, deg))
+    Q_INVOKABLE QVariantMap feasibleRegion(double distance);
+
+    /// Stage timing for QML code, only recorded in BALLISTICS_TRACE builds (see StageTrace.h)
+    /// \return Steady clock [ns] to pass back to traceStage() as beginNs
+    Q_INVOKABLE double traceNow() const;
+    Q_INVOKABLE void traceStage(const QString& name, double beginNs);
+
+    /// Writes the recorded stages as Chrome trace_event JSON for Perfetto
+    Q_INVOKABLE bool dumpTrace(const QString& path);
+
     //radians_per_second_t QuadraticFormula(double a, double b, double c, bool subtract);
 
+    /// Current physical properties for use with the stateless solvers in ShotSolver.h
+    ShooterConfig GetShooterConfig() const
+    {
+        return ShooterConfig{m_flywheelMass, m_flywheelRadius, m_minAngle, m_maxAngle, m_heightRobot, m_bClampAngle, m_flywheelInertiaFrac};
+    }
+
     void SetClampAngleFlag(bool bClampAngle) { m_bClampAngle = bClampAngle; }
     void SetHeightAboveHub(meter_t hgt) { m_heightAboveHub = hgt; }
+    void SetHeightAboveHubPolicy(const HeightAboveHubPolicy& policy) { m_heightPolicy = policy; }
     void SetHeightTarget(meter_t hgt) { m_heightTarget = hgt; }
 
     std::string GetIntermediateResults();
@@ -165,16 +214,29 @@ public:
     std::string GetCsvHeader2();
     std::string GetCsvDataRow2();
 
+    /// Allocation free forms of GetCsvDataRow() and GetCsvDataRow2() for sweep output
+    void WriteCsvDataRow(TextBuffer& out) const;
+    void WriteCsvDataRow2(TextBuffer& out) const;
+
+    /// Column layouts of the two CSV tables, change a column's precision here
+    CsvFormat& GetCsvFormat() { return m_csvFormat; }
+    CsvFormat& GetCsvFormat2() { return m_csvFormat2; }
+
+    static constexpr size_t c_csvRowColumns = 10;
+    static constexpr size_t c_csvRow2Columns = 8;
+
 signals:
     void parabolaFitCoeffsChanged();
     void inputsAndOutputsChanged();
     void physicalPropertiesChanged();
+    void solverStatsChanged();
 
  private:
     // Physical "constants"
     kilogram_t m_flywheelMass = c_flywheelMass;
     meter_t m_flywheelRadius = c_flywheelRadius;
     scalar_t m_massRatio = c_massRatio;
+    scalar_t m_flywheelInertiaFrac = flywheelRotInertiaFrac;
     degree_t m_minAngle = c_minAngle;
     degree_t m_maxAngle = c_maxAngle;
 
@@ -215,4 +277,15 @@ signals:
     double m_parabolaFitY3 = 0.0;
 
     bool m_bClampAngle = true;
+
+    HeightAboveHubPolicy m_heightPolicy;    //!< Empty until set, calcWithHeightPolicy() then keeps m_heightAboveHub
+    FeasibleRegionCache m_feasibleRegions;
+    SolverStatsSnapshot m_solverStats;
+
+    CsvFormat m_csvFormat;      //!< GetCsvHeader() and GetCsvDataRow()
+    CsvFormat m_csvFormat2;     //!< GetCsvHeader2() and GetCsvDataRow2()
+
+    /// traceStage() names, interned on first use so recording a stage only writes the trace ring. GUI thread only.
+    std::vector<std::pair<QString, const char*>> m_traceNames;
+    const char* TraceStageName(const QString& name);
 };
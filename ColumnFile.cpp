@@ -0,0 +1,508 @@
+#include "ColumnFile.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+    constexpr char c_fileMagic[8] = { 'B', 'V', 'C', 'O', 'L', 'S', '0', '1' };
+    constexpr char c_trailerMagic[8] = { 'B', 'V', 'C', 'O', 'L', 'E', 'N', 'D' };
+    constexpr uint32_t c_version = 1;
+    constexpr size_t c_chunkAlignment = 64;
+    constexpr size_t c_nameLength = 32;
+
+    struct ColumnRecord
+    {
+        char name[c_nameLength];
+        uint8_t type;
+        uint8_t encoding;
+        uint8_t reserved[6];
+        double quantum;
+    };
+    static_assert(sizeof(ColumnRecord) == 48, "footer layout");
+
+    struct ChunkRecord
+    {
+        uint64_t offset;
+        uint64_t bytes;
+        uint64_t rows;
+        int64_t base;           // First quantized value of a delta chunk
+        uint32_t column;
+        uint32_t group;
+        uint8_t encoding;
+        uint8_t reserved[7];
+    };
+    static_assert(sizeof(ChunkRecord) == 48, "footer layout");
+
+    struct Trailer
+    {
+        uint64_t footerOffset;
+        uint64_t rows;
+        uint32_t columns;
+        uint32_t chunks;
+        uint32_t groups;
+        uint32_t version;
+        char magic[8];
+    };
+    static_assert(sizeof(Trailer) == 40, "footer layout");
+
+    size_t TypeSize(ColumnType type)
+    {
+        switch (type)
+        {
+        case c_columnFloat64:   return sizeof(double);
+        case c_columnFloat32:   return sizeof(float);
+        case c_columnUInt32:    return sizeof(uint32_t);
+        case c_columnUInt8:     return sizeof(uint8_t);
+        }
+        return 0;
+    }
+
+    size_t StoredSize(ColumnType type, ColumnEncoding encoding)
+    {
+        switch (encoding)
+        {
+        case c_encodeDelta:     return sizeof(int16_t);
+        case c_encodeQuantized: return sizeof(int32_t);
+        case c_encodeRaw:       return TypeSize(type);
+        }
+        return 0;
+    }
+
+    /// Quantized steps of every value, false if one is not finite or does not fit
+    bool Quantize(const double* values, size_t rows, double quantum, int64_t limit, vector<int64_t>& steps)
+    {
+        steps.resize(rows);
+        for (size_t i = 0; i < rows; i++)
+        {
+            double q = round(values[i] / quantum);
+            if (!(fabs(q) <= static_cast<double>(limit)))
+                return false;
+            steps[i] = static_cast<int64_t>(q);
+        }
+        return true;
+    }
+}
+
+struct ColumnFileWriter::Chunk
+{
+    ChunkRecord record;
+};
+
+ColumnFileWriter::ColumnFileWriter(const string& path, vector<ColumnSpec> columns)
+    : m_columns(move(columns))
+{
+    for (ColumnSpec& c : m_columns)
+    {
+        // Only float64 columns can be quantized
+        if (c.type != c_columnFloat64 || !(c.quantum > 0.0))
+            c.encoding = c_encodeRaw;
+    }
+
+    m_file = fopen(path.c_str(), "wb");
+    if (m_file != nullptr)
+        Write(c_fileMagic, sizeof(c_fileMagic));
+}
+
+ColumnFileWriter::~ColumnFileWriter()
+{
+    Close();
+}
+
+bool ColumnFileWriter::Write(const void* data, size_t bytes)
+{
+    if (m_bFailed || fwrite(data, 1, bytes, m_file) != bytes)
+    {
+        m_bFailed = true;
+        return false;
+    }
+    m_offset += bytes;
+    return true;
+}
+
+bool ColumnFileWriter::AppendGroup(size_t rows, const vector<const void*>& columns)
+{
+    if (m_file == nullptr || columns.size() != m_columns.size())
+        return false;
+
+    static const char zeros[c_chunkAlignment] = {};
+    vector<int64_t> steps;
+    vector<int16_t> deltas;
+    vector<int32_t> quantized;
+
+    for (size_t c = 0; c < m_columns.size(); c++)
+    {
+        const ColumnSpec& spec = m_columns[c];
+        Write(zeros, (c_chunkAlignment - m_offset % c_chunkAlignment) % c_chunkAlignment);
+
+        Chunk chunk{};
+        chunk.record.offset = m_offset;
+        chunk.record.rows = rows;
+        chunk.record.column = static_cast<uint32_t>(c);
+        chunk.record.group = m_groups;
+
+        // Most compact encoding the values fit, the spec's encoding at best
+        ColumnEncoding encoding = c_encodeRaw;
+        const double* values = static_cast<const double*>(columns[c]);
+        if (spec.encoding != c_encodeRaw && rows > 0 && Quantize(values, rows, spec.quantum, numeric_limits<int32_t>::max(), steps))
+        {
+            encoding = c_encodeQuantized;
+            if (spec.encoding == c_encodeDelta)
+            {
+                deltas.resize(rows);
+                bool bFits = true;
+                for (size_t i = 0; i < rows; i++)
+                {
+                    int64_t d = i == 0 ? 0 : steps[i] - steps[i - 1];
+                    bFits = bFits && d >= numeric_limits<int16_t>::min() && d <= numeric_limits<int16_t>::max();
+                    deltas[i] = static_cast<int16_t>(d);
+                }
+                encoding = bFits ? c_encodeDelta : c_encodeQuantized;
+            }
+        }
+
+        chunk.record.encoding = encoding;
+        chunk.record.bytes = rows * StoredSize(spec.type, encoding);
+        if (encoding == c_encodeDelta)
+        {
+            chunk.record.base = steps[0];
+            Write(deltas.data(), deltas.size() * sizeof(int16_t));
+        }
+        else if (encoding == c_encodeQuantized)
+        {
+            quantized.assign(steps.begin(), steps.end());
+            Write(quantized.data(), quantized.size() * sizeof(int32_t));
+        }
+        else
+        {
+            Write(columns[c], chunk.record.bytes);
+        }
+        m_chunks.push_back(chunk);
+    }
+
+    m_rows += rows;
+    m_groups++;
+    return !m_bFailed;
+}
+
+bool ColumnFileWriter::Close()
+{
+    if (m_file == nullptr)
+        return false;
+
+    Trailer trailer{};
+    trailer.footerOffset = m_offset;
+    trailer.rows = m_rows;
+    trailer.columns = static_cast<uint32_t>(m_columns.size());
+    trailer.chunks = static_cast<uint32_t>(m_chunks.size());
+    trailer.groups = m_groups;
+    trailer.version = c_version;
+    memcpy(trailer.magic, c_trailerMagic, sizeof(trailer.magic));
+
+    for (const ColumnSpec& c : m_columns)
+    {
+        ColumnRecord r{};
+        memcpy(r.name, c.name.data(), std::min(c.name.size(), c_nameLength - 1));
+        r.type = c.type;
+        r.encoding = c.encoding;
+        r.quantum = c.quantum;
+        Write(&r, sizeof(r));
+    }
+    for (const Chunk& c : m_chunks)
+        Write(&c.record, sizeof(c.record));
+    Write(&trailer, sizeof(trailer));
+
+    if (fclose(m_file) != 0)
+        m_bFailed = true;
+    m_file = nullptr;
+    return !m_bFailed;
+}
+
+ColumnFileReader::~ColumnFileReader()
+{
+    Close();
+}
+
+bool ColumnFileReader::Open(const string& path)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    m_fileHandle = file;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        Close();
+        return false;
+    }
+    m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = m_mapping != nullptr ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (view == nullptr)
+    {
+        Close();
+        return false;
+    }
+    m_base = static_cast<const unsigned char*>(view);
+    m_size = static_cast<size_t>(size.QuadPart);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    void* view = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);      // The mapping keeps the file open
+    if (view == MAP_FAILED)
+        return false;
+    m_base = static_cast<const unsigned char*>(view);
+    m_size = static_cast<size_t>(st.st_size);
+#endif
+
+    // Everything below only trusts offsets it has bounds checked
+    Trailer trailer;
+    if (m_size < sizeof(c_fileMagic) + sizeof(trailer) || memcmp(m_base, c_fileMagic, sizeof(c_fileMagic)) != 0)
+    {
+        Close();
+        return false;
+    }
+    memcpy(&trailer, m_base + m_size - sizeof(trailer), sizeof(trailer));
+    uint64_t footerBytes = uint64_t(trailer.columns) * sizeof(ColumnRecord) + uint64_t(trailer.chunks) * sizeof(ChunkRecord);
+    if (memcmp(trailer.magic, c_trailerMagic, sizeof(trailer.magic)) != 0
+        || trailer.version != c_version
+        || trailer.chunks != uint64_t(trailer.columns) * trailer.groups
+        || trailer.footerOffset + footerBytes + sizeof(trailer) != m_size)
+    {
+        Close();
+        return false;
+    }
+
+    const unsigned char* footer = m_base + trailer.footerOffset;
+    m_columns.resize(trailer.columns);
+    for (size_t c = 0; c < m_columns.size(); c++)
+    {
+        ColumnRecord r;
+        memcpy(&r, footer + c * sizeof(r), sizeof(r));
+        r.name[c_nameLength - 1] = '\0';
+        m_columns[c].name = r.name;
+        m_columns[c].type = static_cast<ColumnType>(r.type);
+        m_columns[c].encoding = static_cast<ColumnEncoding>(r.encoding);
+        m_columns[c].quantum = r.quantum;
+        if (TypeSize(m_columns[c].type) == 0)
+        {
+            Close();
+            return false;
+        }
+    }
+
+    const unsigned char* chunkRecords = footer + m_columns.size() * sizeof(ColumnRecord);
+    m_chunks.resize(trailer.chunks);
+    m_groups = trailer.groups;
+    m_rows = 0;
+    for (size_t i = 0; i < m_chunks.size(); i++)
+    {
+        ChunkRecord r;
+        memcpy(&r, chunkRecords + i * sizeof(r), sizeof(r));
+        bool bValid = r.column < m_columns.size() && r.group < m_groups
+                   && size_t(r.group) * m_columns.size() + r.column == i
+                   && r.encoding <= c_encodeRaw
+                   && r.offset % c_chunkAlignment == 0
+                   && r.offset <= trailer.footerOffset && r.bytes <= trailer.footerOffset - r.offset
+                   && r.bytes == r.rows * StoredSize(m_columns[r.column].type, static_cast<ColumnEncoding>(r.encoding));
+        // Every column of a group has the rows of its first column
+        bValid = bValid && (r.column == 0 || r.rows == m_chunks[i - r.column].rows);
+        if (!bValid)
+        {
+            Close();
+            return false;
+        }
+        m_chunks[i] = ChunkView{ m_base + r.offset, static_cast<size_t>(r.rows), r.base, static_cast<ColumnEncoding>(r.encoding) };
+        if (r.column == 0)
+            m_rows += m_chunks[i].rows;
+    }
+    if (m_rows != trailer.rows)
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void ColumnFileReader::Close()
+{
+#ifdef _WIN32
+    if (m_base != nullptr)
+        UnmapViewOfFile(m_base);
+    if (m_mapping != nullptr)
+        CloseHandle(m_mapping);
+    if (m_fileHandle != nullptr)
+        CloseHandle(m_fileHandle);
+    m_mapping = nullptr;
+    m_fileHandle = nullptr;
+#else
+    if (m_base != nullptr)
+        munmap(const_cast<unsigned char*>(m_base), m_size);
+#endif
+    m_base = nullptr;
+    m_size = 0;
+    m_columns.clear();
+    m_chunks.clear();
+    m_rows = 0;
+    m_groups = 0;
+}
+
+size_t ColumnFileReader::FindColumn(const string& name) const
+{
+    for (size_t c = 0; c < m_columns.size(); c++)
+    {
+        if (m_columns[c].name == name)
+            return c;
+    }
+    return m_columns.size();
+}
+
+size_t ColumnFileReader::GroupRows(size_t group) const
+{
+    return m_chunks[group * m_columns.size()].rows;
+}
+
+ColumnEncoding ColumnFileReader::ChunkEncoding(size_t group, size_t column) const
+{
+    return m_chunks[group * m_columns.size() + column].encoding;
+}
+
+void ColumnFileReader::Decode(size_t column, vector<double>& out) const
+{
+    out.resize(m_rows);
+    const ColumnSpec& spec = m_columns[column];
+    size_t row = 0;
+    for (size_t g = 0; g < m_groups; g++)
+    {
+        const ChunkView& c = m_chunks[g * m_columns.size() + column];
+        double* dst = out.data() + row;
+        // memcpy out of the mapping, the stored values are aligned but the compiler cannot know that
+        auto load = [&c](size_t i, auto value)
+        {
+            memcpy(&value, static_cast<const unsigned char*>(c.data) + i * sizeof(value), sizeof(value));
+            return value;
+        };
+
+        if (c.encoding == c_encodeDelta)
+        {
+            int64_t step = c.base;
+            for (size_t i = 0; i < c.rows; i++)
+            {
+                step += load(i, int16_t());
+                dst[i] = static_cast<double>(step) * spec.quantum;
+            }
+        }
+        else if (c.encoding == c_encodeQuantized)
+        {
+            for (size_t i = 0; i < c.rows; i++)
+                dst[i] = static_cast<double>(load(i, int32_t())) * spec.quantum;
+        }
+        else
+        {
+            for (size_t i = 0; i < c.rows; i++)
+            {
+                switch (spec.type)
+                {
+                case c_columnFloat64:   dst[i] = load(i, double()); break;
+                case c_columnFloat32:   dst[i] = load(i, float()); break;
+                case c_columnUInt32:    dst[i] = load(i, uint32_t()); break;
+                case c_columnUInt8:     dst[i] = load(i, uint8_t()); break;
+                }
+            }
+        }
+        row += c.rows;
+    }
+}
+
+vector<ColumnSpec> ShotBatchColumns()
+{
+    return {
+        { "distance", c_columnFloat64, c_encodeDelta, 1e-5 },
+        { "targetDist", c_columnFloat64, c_encodeDelta, 1e-5 },
+        { "heightAboveHub", c_columnFloat64, c_encodeDelta, 1e-5 },
+        { "targetHeight", c_columnFloat64, c_encodeDelta, 1e-5 },
+        { "rpm", c_columnFloat64, c_encodeRaw, 0.01 },
+        { "angleInit", c_columnFloat64, c_encodeRaw, 1e-5 },
+        { "landingAngle", c_columnFloat64, c_encodeRaw, 1e-5 },
+        { "timeOfFlight", c_columnFloat64, c_encodeRaw, 1e-6 },
+        { "heightMax", c_columnFloat64, c_encodeRaw, 1e-5 },
+        { "status", c_columnUInt8, c_encodeRaw, 0.0 },
+    };
+}
+
+bool AppendShotBatch(ColumnFileWriter& writer, const ShotBatchInputs& inputs, const ShotBatchResults& results)
+{
+    // The inputs follow the lane column, which only differs from the row after compaction
+    const size_t rows = results.Size();
+    array<vector<double>, 4> picked;
+    const vector<double>* source[4] = { &inputs.distance, &inputs.targetDist, &inputs.heightAboveHub, &inputs.targetHeight };
+    for (size_t c = 0; c < picked.size(); c++)
+    {
+        picked[c].resize(rows);
+        for (size_t i = 0; i < rows; i++)
+            picked[c][i] = (*source[c])[results.lane[i]];
+    }
+
+    return writer.AppendGroup(rows, {
+        picked[0].data(), picked[1].data(), picked[2].data(), picked[3].data(),
+        results.rpm.data(), results.angleInit.data(), results.landingAngle.data(), results.timeOfFlight.data(),
+        results.heightMax.data(), results.status.data() });
+}
+
+bool WriteShotSweepColumns(const ShooterConfig& config, const ShotSweepGrid& grid, const string& path, unsigned threads, const vector<ColumnSpec>& columns)
+{
+    ColumnFileWriter writer(path, columns);
+    if (!writer.IsOpen())
+        return false;
+
+    // Solve a slab of rows in parallel, then append it in row order
+    const size_t rows = grid.Rows();
+    if (threads == 0)
+        threads = DefaultThreadCount();
+    const size_t slab = std::min<size_t>(rows, size_t(threads) * 8);
+    vector<ShotBatchInputs> inputs(slab);
+    vector<ShotBatchResults> results(slab);
+
+    bool bOk = true;
+    for (size_t first = 0; first < rows && bOk; first += slab)
+    {
+        size_t count = std::min(slab, rows - first);
+        ParallelFor(count, threads, [&](size_t begin, size_t end, unsigned)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                grid.RowInputs(first + i, inputs[i]);
+                SolveShotBatch(config, inputs[i], results[i]);
+            }
+        });
+        for (size_t i = 0; i < count && bOk; i++)
+            bOk = AppendShotBatch(writer, inputs[i], results[i]);
+    }
+
+    return writer.Close() && bOk;
+}
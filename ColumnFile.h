@@ -0,0 +1,170 @@
+/// Columnar binary file for large sweeps
+///
+/// Rows arrive in groups (one AppendGroup() per solver batch) and each group stores every column as
+/// its own chunk, 64 byte aligned, so a reader that maps the file gets raw columns as plain arrays with
+/// no parsing. A column can instead be quantized to int32 steps of a fixed quantum, or delta coded as
+/// int16 steps from the previous row, which suits the slowly varying inputs of a grid sweep. Encoding
+/// is decided per chunk: a chunk whose values do not fit the requested encoding falls back to the
+/// next wider one, down to raw. A footer at the end indexes the columns and chunks.
+///
+/// Layout: "BVCOLS01", the chunks, the footer (ColumnRecord per column, ChunkRecord per chunk) and a
+/// fixed size trailer pointing back at the footer. Little endian, which covers every target this
+/// app builds for.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "ShotBatch.h"
+#include "SweepWriter.h"
+
+enum ColumnType : uint8_t
+{
+    c_columnFloat64,
+    c_columnFloat32,
+    c_columnUInt32,
+    c_columnUInt8,
+};
+
+/// How a chunk is stored, also the order of fallback from the most compact
+enum ColumnEncoding : uint8_t
+{
+    c_encodeDelta,          //!< First value in ChunkRecord::base, then int16 steps of the quantum
+    c_encodeQuantized,      //!< int32 steps of the quantum
+    c_encodeRaw,            //!< The column's own type
+};
+
+struct ColumnSpec
+{
+    std::string name;                       //!< Up to 31 characters
+    ColumnType type = c_columnFloat64;
+    ColumnEncoding encoding = c_encodeRaw;  //!< Delta and quantized need a float64 column
+    double quantum = 0.0;                   //!< Step of the quantized and delta encodings
+};
+
+/// Contiguous values of one chunk, std::span is C++20
+template <class T>
+struct ColumnSpan
+{
+    const T* data = nullptr;
+    size_t size = 0;
+
+    const T* begin() const { return data; }
+    const T* end() const { return data + size; }
+    const T& operator[](size_t i) const { return data[i]; }
+    bool empty() const { return size == 0; }
+};
+
+class ColumnFileWriter
+{
+public:
+    ColumnFileWriter(const std::string& path, std::vector<ColumnSpec> columns);
+    ~ColumnFileWriter();
+
+    ColumnFileWriter(const ColumnFileWriter&) = delete;
+    ColumnFileWriter& operator=(const ColumnFileWriter&) = delete;
+
+    bool IsOpen() const { return m_file != nullptr; }
+
+    /// Appends rows to every column
+    /// \param columns  One pointer per column to rows values of the column's type
+    bool AppendGroup(size_t rows, const std::vector<const void*>& columns);
+
+    /// Writes the footer and closes the file
+    /// \return False if any write failed
+    bool Close();
+
+private:
+    struct Chunk;
+
+    bool Write(const void* data, size_t bytes);
+
+    FILE* m_file = nullptr;
+    std::vector<ColumnSpec> m_columns;
+    std::vector<Chunk> m_chunks;
+    uint64_t m_offset = 0;
+    uint64_t m_rows = 0;
+    uint32_t m_groups = 0;
+    bool m_bFailed = false;
+};
+
+class ColumnFileReader
+{
+public:
+    ColumnFileReader() = default;
+    ~ColumnFileReader();
+
+    ColumnFileReader(const ColumnFileReader&) = delete;
+    ColumnFileReader& operator=(const ColumnFileReader&) = delete;
+
+    /// Maps the file and checks the footer
+    bool Open(const std::string& path);
+    void Close();
+
+    size_t Rows() const { return m_rows; }
+    size_t Groups() const { return m_groups; }
+    size_t Columns() const { return m_columns.size(); }
+    const ColumnSpec& Column(size_t column) const { return m_columns[column]; }
+    /// \return Column index, or Columns() if there is none by that name
+    size_t FindColumn(const std::string& name) const;
+
+    size_t GroupRows(size_t group) const;
+    ColumnEncoding ChunkEncoding(size_t group, size_t column) const;
+
+    /// The chunk as stored, empty unless it is raw and T is the column's type. No copy, valid until Close().
+    template <class T>
+    ColumnSpan<T> RawChunk(size_t group, size_t column) const
+    {
+        const ChunkView& c = m_chunks[group * m_columns.size() + column];
+        if (c.encoding != c_encodeRaw || !TypeMatches(m_columns[column].type, static_cast<T*>(nullptr)))
+            return ColumnSpan<T>();
+        return ColumnSpan<T>{ static_cast<const T*>(c.data), c.rows };
+    }
+
+    /// Every group of the column as double, whatever the encoding
+    void Decode(size_t column, std::vector<double>& out) const;
+
+private:
+    struct ChunkView
+    {
+        const void* data;
+        size_t rows;
+        int64_t base;
+        ColumnEncoding encoding;
+    };
+
+    static bool TypeMatches(ColumnType t, const double*) { return t == c_columnFloat64; }
+    static bool TypeMatches(ColumnType t, const float*) { return t == c_columnFloat32; }
+    static bool TypeMatches(ColumnType t, const uint32_t*) { return t == c_columnUInt32; }
+    static bool TypeMatches(ColumnType t, const uint8_t*) { return t == c_columnUInt8; }
+
+    const unsigned char* m_base = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_fileHandle = nullptr;
+    void* m_mapping = nullptr;
+#endif
+    std::vector<ColumnSpec> m_columns;
+    std::vector<ChunkView> m_chunks;        //!< Group major, m_chunks[group * Columns() + column]
+    size_t m_rows = 0;
+    size_t m_groups = 0;
+};
+
+/// Columns FormatShotBatchCsv() writes plus max height and the ShotStatus. The grid inputs are delta
+/// coded at 10 um. The results are raw, so a reader gets them from RawChunk() without decoding. Each
+/// result spec still carries a quantum (max height 10 um, rpm 0.01, angles 1e-5 deg, time of flight
+/// 1 us), so a caller that prefers size over mapping can set its encoding to delta or quantized.
+std::vector<ColumnSpec> ShotBatchColumns();
+
+/// Appends the batch as one group in ShotBatchColumns() order, inputs picked by each row's lane
+bool AppendShotBatch(ColumnFileWriter& writer, const ShotBatchInputs& inputs, const ShotBatchResults& results);
+
+/// WriteShotSweep() into a column file, one group per distance
+/// \param threads  0 uses std::thread::hardware_concurrency()
+/// \param columns  ShotBatchColumns() with any encodings changed, the names, types and order must stay
+bool WriteShotSweepColumns(const ShooterConfig& config, const ShotSweepGrid& grid, const std::string& path, unsigned threads = 0
+                         , const std::vector<ColumnSpec>& columns = ShotBatchColumns());
@@ -0,0 +1,63 @@
+/// Counter-based random numbers (Philox4x32-10, Salmon et al. SC11)
+///
+/// Each draw is a pure function of (key, counter), so sample i gets the same random numbers
+/// no matter which thread evaluates it or how the work is split.
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+class CounterRng
+{
+public:
+    using Block = std::array<uint32_t, 4>;
+
+    explicit CounterRng(uint64_t seed)
+        : m_key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}
+    {
+    }
+
+    /// Four independent 32 bit words for (index, stream)
+    Block Generate(uint64_t index, uint32_t stream = 0) const
+    {
+        Block ctr{static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32), stream, 0};
+        std::array<uint32_t, 2> key = m_key;
+        for (int round = 0; round < 10; round++)
+        {
+            uint64_t p0 = static_cast<uint64_t>(c_mult0) * ctr[0];
+            uint64_t p1 = static_cast<uint64_t>(c_mult1) * ctr[2];
+            ctr = Block{ static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0]
+                       , static_cast<uint32_t>(p1)
+                       , static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1]
+                       , static_cast<uint32_t>(p0) };
+            key[0] += c_weyl0;
+            key[1] += c_weyl1;
+        }
+        return ctr;
+    }
+
+    /// Uniform in (0, 1), never exactly 0 so it is safe to take the log of
+    static double ToUniform(uint32_t u)
+    {
+        return (static_cast<double>(u) + 0.5) * (1.0 / 4294967296.0);
+    }
+
+    /// Two standard normals from two uniforms (Box-Muller)
+    static void ToNormal(uint32_t u0, uint32_t u1, double& n0, double& n1)
+    {
+        double r = std::sqrt(-2.0 * std::log(ToUniform(u0)));
+        double theta = 6.283185307179586 * ToUniform(u1);
+        n0 = r * std::cos(theta);
+        n1 = r * std::sin(theta);
+    }
+
+private:
+    static constexpr uint32_t c_mult0 = 0xD2511F53;
+    static constexpr uint32_t c_mult1 = 0xCD9E8D57;
+    static constexpr uint32_t c_weyl0 = 0x9E3779B9;
+    static constexpr uint32_t c_weyl1 = 0xBB67AE85;
+
+    std::array<uint32_t, 2> m_key;
+};
@@ -0,0 +1,62 @@
+#include "CsvFormat.h"
+
+#include <charconv>
+#include <cstring>
+
+using namespace std;
+
+void TextBuffer::Append(char c)
+{
+    if (m_bOverflow || m_size == m_capacity)
+    {
+        m_bOverflow = true;
+        return;
+    }
+    m_data[m_size++] = c;
+}
+
+void TextBuffer::Append(string_view text)
+{
+    if (m_bOverflow || text.size() > m_capacity - m_size)
+    {
+        m_bOverflow = true;
+        return;
+    }
+    memcpy(m_data + m_size, text.data(), text.size());
+    m_size += text.size();
+}
+
+void TextBuffer::AppendFixed(double value, int precision)
+{
+    if (m_bOverflow)
+        return;
+
+    to_chars_result r = to_chars(m_data + m_size, m_data + m_capacity, value, chars_format::fixed, precision);
+    if (r.ec != errc())
+    {
+        m_bOverflow = true;
+        return;
+    }
+    m_size = static_cast<size_t>(r.ptr - m_data);
+}
+
+CsvFormat::CsvFormat(vector<CsvColumn> columns)
+    : m_columns(move(columns))
+{
+    for (size_t i = 0; i < m_columns.size(); i++)
+    {
+        if (i > 0)
+            m_header += ',';
+        m_header += m_columns[i].header;
+    }
+}
+
+void CsvFormat::WriteRow(TextBuffer& out, const double* values) const
+{
+    for (size_t i = 0; i < m_columns.size(); i++)
+    {
+        if (i > 0)
+            out.Append(',');
+        out.AppendFixed(values[i], m_columns[i].precision);
+    }
+}
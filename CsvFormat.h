@@ -0,0 +1,70 @@
+/// Allocation free CSV and text formatting
+///
+/// TextBuffer appends into a caller owned char buffer with std::to_chars, so formatting a row costs no
+/// heap allocations and no locale lookups. CsvFormat holds the column layout of a table: each column's
+/// header and its digits after the decimal point. The header line is built once and reused for every
+/// table written with the format.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class TextBuffer
+{
+public:
+    TextBuffer(char* data, size_t capacity) : m_data(data), m_capacity(capacity) {}
+
+    template <size_t N>
+    explicit TextBuffer(std::array<char, N>& storage) : m_data(storage.data()), m_capacity(N) {}
+
+    void Clear() { m_size = 0; m_bOverflow = false; }
+
+    void Append(char c);
+    void Append(std::string_view text);
+    /// Fixed notation like printf("%.*f"), nan and inf print as such
+    void AppendFixed(double value, int precision);
+
+    std::string_view View() const { return std::string_view(m_data, m_size); }
+    std::string ToString() const { return std::string(m_data, m_size); }
+    size_t Size() const { return m_size; }
+    size_t Capacity() const { return m_capacity; }
+    /// Something did not fit, the text stops before the first piece that did not
+    bool Overflowed() const { return m_bOverflow; }
+
+private:
+    char* m_data;
+    size_t m_capacity;
+    size_t m_size = 0;
+    bool m_bOverflow = false;
+};
+
+struct CsvColumn
+{
+    std::string header;         //!< Header text, including the units
+    int precision = 2;          //!< Digits after the decimal point
+};
+
+class CsvFormat
+{
+public:
+    explicit CsvFormat(std::vector<CsvColumn> columns);
+
+    size_t Columns() const { return m_columns.size(); }
+    const CsvColumn& Column(size_t column) const { return m_columns[column]; }
+    void SetPrecision(size_t column, int precision) { m_columns[column].precision = precision; }
+
+    /// Comma separated column headers, no line ending
+    const std::string& Header() const { return m_header; }
+
+    /// Appends one row, comma separated with no line ending
+    /// \param values   One value per column
+    void WriteRow(TextBuffer& out, const double* values) const;
+
+private:
+    std::vector<CsvColumn> m_columns;
+    std::string m_header;
+};
@@ -0,0 +1,151 @@
+#include "DesignOptimizer.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace
+{
+    /// What a (minAngle, maxAngle) pair needs over the distance envelope, independent of the flywheel
+    struct AngleEnvelope
+    {
+        degree_t minAngle;
+        degree_t maxAngle;
+        meters_per_second_t peakVel = meters_per_second_t(0.0);
+        double clampShare = 0.0;
+        bool bReachable = true;     // Every distance has a real solution within the hood limits
+    };
+
+    AngleEnvelope SolveEnvelope(const DesignSpace& space, degree_t minAngle, degree_t maxAngle)
+    {
+        ShooterConfig config;
+        config.minAngle = minAngle;
+        config.maxAngle = maxAngle;
+        config.launchHeight = space.launchHeight;
+
+        AngleEnvelope e;
+        e.minAngle = minAngle;
+        e.maxAngle = maxAngle;
+        size_t clamped = 0;
+        for (meter_t d : space.distances)
+        {
+            ShotSolution s = SolveShot(config, d, space.targetDist, space.heightAboveHub, space.targetHeight);
+            if (!isfinite(s.velInit.value()))
+            {
+                e.bReachable = false;
+                break;
+            }
+            e.peakVel = std::max(e.peakVel, s.velInit);
+            clamped += s.bClamped ? 1 : 0;
+        }
+        e.clampShare = space.distances.empty() ? 0.0 : static_cast<double>(clamped) / space.distances.size();
+        return e;
+    }
+
+    bool NoWorse(const DesignScore& a, const DesignScore& b)
+    {
+        return a.peakRpm <= b.peakRpm && a.spinUpTime <= b.spinUpTime && a.recoveryTime <= b.recoveryTime && a.clampShare <= b.clampShare;
+    }
+
+    /// Adds s to the front unless something there is at least as good, dropping whatever s dominates.
+    /// Designs with identical objectives keep only the first one.
+    void InsertPareto(vector<DesignScore>& front, const DesignScore& s)
+    {
+        for (const DesignScore& f : front)
+        {
+            if (NoWorse(f, s))
+                return;
+        }
+        front.erase(remove_if(front.begin(), front.end(), [&s](const DesignScore& f) { return s.Dominates(f); }), front.end());
+        front.push_back(s);
+    }
+}
+
+bool DesignScore::Dominates(const DesignScore& o) const
+{
+    bool bBetter = peakRpm < o.peakRpm || spinUpTime < o.spinUpTime || recoveryTime < o.recoveryTime || clampShare < o.clampShare;
+    return NoWorse(*this, o) && bBetter;
+}
+
+DesignSearchResult OptimizeDesign(const DesignSpace& space)
+{
+    DesignSearchResult result;
+
+    // Shot solves once per hood limit pair
+    vector<AngleEnvelope> envelopes;
+    for (degree_t lo : space.minAngles)
+    {
+        for (degree_t hi : space.maxAngles)
+        {
+            if (hi > lo)
+                envelopes.push_back(AngleEnvelope{ lo, hi });
+        }
+    }
+    ParallelFor(envelopes.size(), space.threads, [&](size_t begin, size_t end, unsigned)
+    {
+        for (size_t i = begin; i < end; i++)
+            envelopes[i] = SolveEnvelope(space, envelopes[i].minAngle, envelopes[i].maxAngle);
+    });
+
+    vector<FlywheelGeometry> candidates = space.flywheels;
+    if (candidates.empty())
+    {
+        for (kilogram_t m : space.flywheelMasses)
+        {
+            for (meter_t r : space.flywheelRadii)
+                candidates.push_back(MakeFlywheel(FlywheelPart::SolidCylinder(m, r)));
+        }
+    }
+
+    // Every flywheel against every envelope, each thread keeps its own front
+    const size_t flywheels = candidates.size();
+    const size_t count = envelopes.size() * flywheels;
+    unsigned threads = space.threads == 0 ? DefaultThreadCount() : space.threads;
+    vector<vector<DesignScore>> fronts(threads);
+    vector<size_t> feasible(threads, 0);
+
+    ParallelFor(count, threads, [&](size_t begin, size_t end, unsigned t)
+    {
+        for (size_t n = begin; n < end; n++)
+        {
+            const AngleEnvelope& e = envelopes[n / flywheels];
+            if (!e.bReachable)
+                continue;
+
+            ShooterConfig config;
+            config.SetFlywheel(candidates[n % flywheels]);
+            config.minAngle = e.minAngle;
+            config.maxAngle = e.maxAngle;
+            config.launchHeight = space.launchHeight;
+
+            DesignScore s;
+            s.flywheelMass = config.flywheelMass;
+            s.flywheelRadius = config.flywheelRadius;
+            s.flywheelInertiaFrac = config.flywheelInertiaFrac;
+            s.minAngle = e.minAngle;
+            s.maxAngle = e.maxAngle;
+            s.peakRpm = config.ExitVelToRpm(e.peakVel);
+            s.spinUpTime = FlywheelSpinUpTime(config, space.motor, revolutions_per_minute_t(0.0), s.peakRpm);
+            if (!isfinite(s.spinUpTime.value()))
+                continue;
+            // Recovery time grows with the setpoint, so a burst fired at the peak setpoint is the worst case
+            s.recoveryTime = FlywheelBurstRecoveryTime(config, space.motor, s.peakRpm, space.burstShots, space.feedInterval);
+            s.clampShare = e.clampShare;
+
+            feasible[t]++;
+            InsertPareto(fronts[t], s);
+        }
+    });
+
+    for (unsigned t = 0; t < threads; t++)
+    {
+        result.designsFeasible += feasible[t];
+        for (const DesignScore& s : fronts[t])
+            InsertPareto(result.paretoFront, s);
+    }
+    sort(result.paretoFront.begin(), result.paretoFront.end(), [](const DesignScore& a, const DesignScore& b) { return a.peakRpm < b.peakRpm; });
+    result.designsEvaluated = count;
+    return result;
+}
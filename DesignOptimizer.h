@@ -0,0 +1,58 @@
+/// Flywheel design space search
+///
+/// Sweeps flywheel mass, radius and hood limits (the inputs to Calculations::setPhysicalProperties())
+/// and keeps the designs no other design beats on every objective. The exit velocity and launch angle
+/// SolveShot() picks for a distance depend on the hood limits but not on the flywheel, which only scales
+/// the RPM, so the shot solves are done once per (minAngle, maxAngle) pair and every flywheel is then
+/// scored in constant time from the per pair envelope.
+
+#pragma once
+
+#include <vector>
+
+#include "FlywheelBurst.h"
+
+struct DesignSpace
+{
+    std::vector<kilogram_t> flywheelMasses;
+    std::vector<meter_t> flywheelRadii;
+    std::vector<FlywheelGeometry> flywheels;    //!< Searched instead of the solid cylinder masses x radii grid when not empty
+    std::vector<degree_t> minAngles;
+    std::vector<degree_t> maxAngles;            //!< Pairs with maxAngle <= minAngle are skipped
+    std::vector<meter_t> distances;             //!< Distance envelope the design has to cover
+    meter_t targetDist = defaultTargetDist;
+    meter_t heightAboveHub = defaultHeightAboveHub;
+    meter_t targetHeight = defaultTargetHeight;
+    meter_t launchHeight = robotHeight;
+    FlywheelMotor motor;
+    int burstShots = 5;                         //!< Balls in the burst the recovery time is scored on
+    second_t feedInterval = second_t(0.1);      //!< Time between balls in that burst
+    unsigned threads = 0;                       //!< 0 uses std::thread::hardware_concurrency()
+};
+
+/// Objectives are all minimized
+struct DesignScore
+{
+    kilogram_t flywheelMass = kilogram_t(0.0);
+    meter_t flywheelRadius = meter_t(0.0);
+    scalar_t flywheelInertiaFrac = flywheelRotInertiaFrac;
+    degree_t minAngle = degree_t(0.0);
+    degree_t maxAngle = degree_t(0.0);
+
+    revolutions_per_minute_t peakRpm = revolutions_per_minute_t(0.0);  //!< Highest setpoint over the distance envelope
+    second_t spinUpTime = second_t(0.0);        //!< From rest to the peak setpoint
+    second_t recoveryTime = second_t(0.0);      //!< Back to the peak setpoint after a burst of DesignSpace::burstShots, the worst case over the envelope
+    double clampShare = 0.0;                    //!< Fraction of the distances where the launch angle hits a hood limit
+
+    /// At least as good on every objective and better on one
+    bool Dominates(const DesignScore& o) const;
+};
+
+struct DesignSearchResult
+{
+    std::vector<DesignScore> paretoFront;       //!< Sorted by peak RPM
+    size_t designsEvaluated = 0;
+    size_t designsFeasible = 0;                 //!< Reaches every distance with a setpoint below the motor free speed
+};
+
+DesignSearchResult OptimizeDesign(const DesignSpace& space);
@@ -0,0 +1,229 @@
+#include "DragFit.h"
+#include "Parallel.h"
+#include "ShooterModels.h"
+
+#include <cctype>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+using namespace std;
+
+namespace
+{
+    using Dual2 = Dual<2>;  // Partials wrt Cd (0) and Cl (1)
+
+    /// Integrates every shot with the given coefficients, splitting the log across threads.
+    /// Each thread advances its chunk of shots in lock step via SimulateTrajectoryBatch().
+    template <typename T>
+    void SimulateShots(const vector<ShotRecord>& shots
+                     , const T& cd
+                     , const T& cl
+                     , const DragFitOptions& options
+                     , vector<TrajectoryResult<T>>& results)
+    {
+        results.resize(shots.size());
+        ParallelFor(shots.size(), options.threads, [&](size_t begin, size_t end, unsigned)
+        {
+            vector<LaunchConditions<T>> launches;
+            launches.reserve(end - begin);
+            for (size_t i = begin; i < end; i++)
+            {
+                const ShotRecord& s = shots[i];
+                meters_per_second_t vel = DefaultShooterModel::RpmToExitVel(s.rpm, options.flywheelMass, options.flywheelRadius, options.flywheelInertiaFrac);
+                radian_t angle = s.hoodAngle;
+                launches.push_back(LaunchConditions<T>{T(vel.value()), T(angle.value()), (s.landingHeight - options.launchHeight).value()});
+            }
+
+            vector<TrajectoryResult<T>> chunkResults;
+            SimulateTrajectoryBatch(launches, cd, cl, chunkResults);
+            copy(chunkResults.begin(), chunkResults.end(), results.begin() + begin);
+        });
+    }
+
+    double Cost(const vector<ShotRecord>& shots, const vector<bool>& used, const DragCoefficients& coeffs, const DragFitOptions& options)
+    {
+        vector<TrajectoryResult<double>> results;
+        SimulateShots(shots, coeffs.cd, coeffs.cl, options, results);
+
+        double cost = 0.0;
+        for (size_t i = 0; i < shots.size(); i++)
+        {
+            if (!used[i])
+                continue;
+            if (!results[i].bLanded)
+                return numeric_limits<double>::infinity();
+            double r = results[i].landingDist - shots[i].landingDist.value();
+            cost += r * r;
+        }
+        return cost;
+    }
+
+    /// Two sided 95% Student t quantiles (0.975 one sided) for 1 to 30 degrees of freedom
+    constexpr double c_studentT95[] = {
+        12.7062, 4.3027, 3.1824, 2.7764, 2.5706, 2.4469, 2.3646, 2.3060, 2.2622, 2.2281,
+        2.2010, 2.1788, 2.1604, 2.1448, 2.1314, 2.1199, 2.1098, 2.1009, 2.0930, 2.0860,
+        2.0796, 2.0739, 2.0687, 2.0639, 2.0595, 2.0555, 2.0518, 2.0484, 2.0452, 2.0423
+    };
+    constexpr int c_studentT95Rows = static_cast<int>(sizeof(c_studentT95) / sizeof(c_studentT95[0]));
+
+    /// Two sided 95% Student t quantile. Exact from the table for short shot logs, above that the
+    /// Cornish-Fisher expansion about the normal quantile, which is within 1e-4 past 30 dof.
+    constexpr double StudentT95(int dof)
+    {
+        if (dof <= c_studentT95Rows)
+            return c_studentT95[std::max(dof, 1) - 1];
+        constexpr double z = 1.959963985;
+        constexpr double z3 = z * z * z;
+        constexpr double z5 = z3 * z * z;
+        const double v = dof;
+        return z + (z3 + z) / (4.0 * v) + (5.0 * z5 + 16.0 * z3 + 3.0 * z) / (96.0 * v * v);
+    }
+
+    constexpr bool NearT(double t, double expected) { return t > expected - 5e-4 && t < expected + 5e-4; }
+    static_assert(NearT(StudentT95(1), 12.706) && NearT(StudentT95(2), 4.303) && NearT(StudentT95(5), 2.571), "Student t table");
+    static_assert(NearT(StudentT95(31), 2.0395) && NearT(StudentT95(60), 2.0003), "Student t series past the table");
+}
+
+vector<ShotRecord> LoadShotLog(const string& fileName)
+{
+    vector<ShotRecord> shots;
+    ifstream file(fileName);
+    string line;
+    while (getline(file, line))
+    {
+        if (line.empty() || !(isdigit(static_cast<unsigned char>(line[0])) || line[0] == '-' || line[0] == '.'))
+            continue;
+
+        for (auto& c : line)
+        {
+            if (c == ',')
+                c = ' ';
+        }
+
+        istringstream in(line);
+        double rpm = 0.0, angle = 0.0, dist = 0.0, height = 0.0;
+        if (!(in >> rpm >> angle >> dist))
+            continue;
+        in >> height;
+
+        shots.push_back(ShotRecord{revolutions_per_minute_t(rpm), degree_t(angle), foot_t(dist), foot_t(height)});
+    }
+
+    return shots;
+}
+
+vector<double> CalcShotResiduals(const vector<ShotRecord>& shots, const DragCoefficients& coeffs, const DragFitOptions& options)
+{
+    vector<TrajectoryResult<double>> results;
+    SimulateShots(shots, coeffs.cd, coeffs.cl, options, results);
+
+    vector<double> residuals(shots.size());
+    for (size_t i = 0; i < shots.size(); i++)
+    {
+        residuals[i] = results[i].bLanded ? results[i].landingDist - shots[i].landingDist.value()
+                                          : numeric_limits<double>::quiet_NaN();
+    }
+    return residuals;
+}
+
+DragFitResult FitDragCoefficients(const vector<ShotRecord>& shots, const DragFitOptions& options)
+{
+    DragFitResult result;
+    result.coeffs = options.initialGuess;
+
+    DragCoefficients p = options.initialGuess;
+    vector<bool> used(shots.size(), true);
+    vector<TrajectoryResult<Dual2>> sims;
+
+    double lambda = 1e-3;
+    double cost = 0.0;
+    // Normal equations J^T J and J^T r
+    double a00 = 0.0, a01 = 0.0, a11 = 0.0, g0 = 0.0, g1 = 0.0;
+
+    auto linearize = [&]()
+    {
+        SimulateShots(shots, Dual2::Variable(p.cd, 0), Dual2::Variable(p.cl, 1), options, sims);
+        cost = a00 = a01 = a11 = g0 = g1 = 0.0;
+        int n = 0;
+        for (size_t i = 0; i < shots.size(); i++)
+        {
+            // Shots the model cannot land with the starting guess are dropped from the fit
+            if (result.iterations == 0 && !sims[i].bLanded)
+                used[i] = false;
+            if (!used[i])
+                continue;
+
+            double r = sims[i].landingDist.v - shots[i].landingDist.value();
+            const auto& j = sims[i].landingDist.d;
+            cost += r * r;
+            a00 += j[0] * j[0];
+            a01 += j[0] * j[1];
+            a11 += j[1] * j[1];
+            g0 += j[0] * r;
+            g1 += j[1] * r;
+            n++;
+        }
+        return n;
+    };
+
+    int n = linearize();
+    result.shotsUsed = n;
+    if (n < 2)
+        return result;
+
+    for (result.iterations = 1; result.iterations <= options.maxIterations; result.iterations++)
+    {
+        // Solve (J^T J + lambda diag(J^T J)) delta = -J^T r
+        double d00 = a00 * (1.0 + lambda) + 1e-12;
+        double d11 = a11 * (1.0 + lambda) + 1e-12;
+        double det = d00 * d11 - a01 * a01;
+        double delta0 = (-g0 * d11 + g1 * a01) / det;
+        double delta1 = (-g1 * d00 + g0 * a01) / det;
+
+        DragCoefficients trial{p.cd + delta0, p.cl + delta1};
+        double trialCost = Cost(shots, used, trial, options);
+        if (trialCost < cost)
+        {
+            bool bSmallStep = fabs(delta0) + fabs(delta1) < options.tolerance * (fabs(p.cd) + fabs(p.cl) + options.tolerance);
+            bool bSmallGain = cost - trialCost < options.tolerance * cost;
+            p = trial;
+            lambda = std::max(lambda * 0.3, 1e-12);
+            linearize();
+            if (bSmallStep || bSmallGain)
+            {
+                result.bConverged = true;
+                break;
+            }
+        }
+        else
+        {
+            lambda *= 10.0;
+            if (lambda > 1e12)
+            {
+                // No downhill step left, we are at the minimum to within numerical noise
+                result.bConverged = true;
+                break;
+            }
+        }
+    }
+
+    result.iterations = std::min(result.iterations, options.maxIterations);
+    result.coeffs = p;
+    result.rmsResidual = sqrt(cost / n);
+
+    // Covariance = s^2 (J^T J)^-1
+    int dof = n - 2;
+    double det = a00 * a11 - a01 * a01;
+    if (dof > 0 && det > 0.0)
+    {
+        double s2 = cost / dof;
+        result.cdStdErr = sqrt(s2 * a11 / det);
+        result.clStdErr = sqrt(s2 * a00 / det);
+        double t = StudentT95(dof);
+        result.cdConfidence95 = t * result.cdStdErr;
+        result.clConfidence95 = t * result.clStdErr;
+    }
+
+    return result;
+}
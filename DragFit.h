@@ -0,0 +1,56 @@
+/// Drag/lift coefficient identification from logged shots
+///
+/// Fits Cd and Cl of the drag-aware trajectory model (Trajectory.h) to measured landing
+/// distances with Levenberg-Marquardt. Residual Jacobians come from forward-mode AD (Dual.h)
+/// and all logged shots are integrated in parallel batches.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Trajectory.h"
+
+/// One logged shot
+struct ShotRecord
+{
+    revolutions_per_minute_t rpm;
+    degree_t hoodAngle;
+    meter_t landingDist;                    //!< Measured horizontal distance from the launch point
+    meter_t landingHeight = meter_t(0.0);   //!< Height above the floor the distance was measured at
+};
+
+struct DragFitOptions
+{
+    DragCoefficients initialGuess;
+    kilogram_t flywheelMass = c_flywheelMass;
+    meter_t flywheelRadius = c_flywheelRadius;
+    scalar_t flywheelInertiaFrac = flywheelRotInertiaFrac;
+    meter_t launchHeight = robotHeight;
+    int maxIterations = 50;
+    double tolerance = 1e-8;                //!< Relative change in cost or step size to stop at
+    unsigned threads = 0;                   //!< 0 uses std::thread::hardware_concurrency()
+};
+
+struct DragFitResult
+{
+    DragCoefficients coeffs;
+    double cdStdErr = 0.0;
+    double clStdErr = 0.0;
+    double cdConfidence95 = 0.0;            //!< Half width of the 95% confidence interval
+    double clConfidence95 = 0.0;
+    double rmsResidual = 0.0;               //!< [m]
+    int iterations = 0;
+    int shotsUsed = 0;                      //!< Shots that landed in the model; the rest are excluded
+    bool bConverged = false;
+};
+
+/// Loads a shot log CSV with columns rpm, hood angle [deg], landing distance [ft] and an optional
+/// landing height [ft]. Lines that do not start with a number (headers, # comments) are skipped.
+std::vector<ShotRecord> LoadShotLog(const std::string& fileName);
+
+/// Fits drag and lift coefficients to the logged shots
+DragFitResult FitDragCoefficients(const std::vector<ShotRecord>& shots, const DragFitOptions& options = DragFitOptions());
+
+/// Simulated minus measured landing distance for every shot, NaN for shots that never land [m]
+std::vector<double> CalcShotResiduals(const std::vector<ShotRecord>& shots, const DragCoefficients& coeffs, const DragFitOptions& options = DragFitOptions());
@@ -0,0 +1,95 @@
+/// Forward-mode automatic differentiation scalar
+///
+/// Dual<N> carries a value and its partial derivatives with respect to N seed variables.
+/// Any code templated on its scalar type can be run with Dual<N> to get exact derivatives
+/// in one pass instead of N+1 finite difference evaluations.
+
+#pragma once
+
+#include <array>
+#include <cmath>
+
+template <int N>
+struct Dual
+{
+    double v = 0.0;                 //!< Value
+    std::array<double, N> d{};      //!< Partial derivatives wrt each seed variable
+
+    constexpr Dual() = default;
+    constexpr Dual(double val) : v(val) {}
+
+    /// Seed variable number idx, i.e. d[idx] = 1
+    static Dual Variable(double val, int idx)
+    {
+        Dual r(val);
+        r.d[idx] = 1.0;
+        return r;
+    }
+
+    Dual& operator+=(const Dual& o) { v += o.v; for (int i = 0; i < N; i++) d[i] += o.d[i]; return *this; }
+    Dual& operator-=(const Dual& o) { v -= o.v; for (int i = 0; i < N; i++) d[i] -= o.d[i]; return *this; }
+    Dual& operator*=(const Dual& o) { *this = *this * o; return *this; }
+    Dual& operator/=(const Dual& o) { *this = *this / o; return *this; }
+
+    friend Dual operator-(const Dual& a)
+    {
+        Dual r(-a.v);
+        for (int i = 0; i < N; i++) r.d[i] = -a.d[i];
+        return r;
+    }
+
+    friend Dual operator+(Dual a, const Dual& b) { return a += b; }
+    friend Dual operator-(Dual a, const Dual& b) { return a -= b; }
+
+    friend Dual operator*(const Dual& a, const Dual& b)
+    {
+        Dual r(a.v * b.v);
+        for (int i = 0; i < N; i++) r.d[i] = a.d[i] * b.v + a.v * b.d[i];
+        return r;
+    }
+
+    friend Dual operator/(const Dual& a, const Dual& b)
+    {
+        Dual r(a.v / b.v);
+        double inv = 1.0 / (b.v * b.v);
+        for (int i = 0; i < N; i++) r.d[i] = (a.d[i] * b.v - a.v * b.d[i]) * inv;
+        return r;
+    }
+
+    // Comparisons only look at the value so control flow matches the plain double path
+    friend bool operator<(const Dual& a, const Dual& b) { return a.v < b.v; }
+    friend bool operator>(const Dual& a, const Dual& b) { return a.v > b.v; }
+    friend bool operator<=(const Dual& a, const Dual& b) { return a.v <= b.v; }
+    friend bool operator>=(const Dual& a, const Dual& b) { return a.v >= b.v; }
+};
+
+/// Applies the chain rule for a unary function f with value fv and derivative dfv at a.v
+template <int N>
+inline Dual<N> DualChain(const Dual<N>& a, double fv, double dfv)
+{
+    Dual<N> r(fv);
+    for (int i = 0; i < N; i++) r.d[i] = dfv * a.d[i];
+    return r;
+}
+
+template <int N> inline Dual<N> sqrt(const Dual<N>& a) { double s = std::sqrt(a.v); return DualChain(a, s, 0.5 / s); }
+template <int N> inline Dual<N> sin(const Dual<N>& a) { return DualChain(a, std::sin(a.v), std::cos(a.v)); }
+template <int N> inline Dual<N> cos(const Dual<N>& a) { return DualChain(a, std::cos(a.v), -std::sin(a.v)); }
+template <int N> inline Dual<N> tan(const Dual<N>& a) { double t = std::tan(a.v); return DualChain(a, t, 1.0 + t * t); }
+template <int N> inline Dual<N> atan(const Dual<N>& a) { return DualChain(a, std::atan(a.v), 1.0 / (1.0 + a.v * a.v)); }
+template <int N> inline Dual<N> exp(const Dual<N>& a) { double e = std::exp(a.v); return DualChain(a, e, e); }
+template <int N> inline Dual<N> log(const Dual<N>& a) { return DualChain(a, std::log(a.v), 1.0 / a.v); }
+template <int N> inline Dual<N> fabs(const Dual<N>& a) { return a.v < 0.0 ? -a : a; }
+
+template <int N>
+inline Dual<N> atan2(const Dual<N>& y, const Dual<N>& x)
+{
+    Dual<N> r(std::atan2(y.v, x.v));
+    double inv = 1.0 / (x.v * x.v + y.v * y.v);
+    for (int i = 0; i < N; i++) r.d[i] = (x.v * y.d[i] - y.v * x.d[i]) * inv;
+    return r;
+}
+
+/// Value part of a scalar, so templated code can branch on either double or Dual<N>
+inline double ValueOf(double a) { return a; }
+template <int N> inline double ValueOf(const Dual<N>& a) { return a.v; }
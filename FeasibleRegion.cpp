@@ -0,0 +1,289 @@
+#include "FeasibleRegion.h"
+#include "Parallel.h"
+#include "SolverStats.h"
+
+#include <array>
+#include <cmath>
+#include <unordered_map>
+
+using namespace std;
+
+namespace
+{
+    constexpr double c_rpmToRadPerSec = 2.0 * 3.141592653589793 / 60.0;
+    constexpr double c_outsideMargin = -1.0;    // Value of the padding ring around the grid [m]
+
+    enum CellEdge { c_edgeBottom, c_edgeRight, c_edgeTop, c_edgeLeft };
+
+    /// Margin evaluator with the per config constants hoisted out
+    struct MarginField
+    {
+        double launchHeight;
+        double distance;
+        double velPerRpm;
+
+        double operator()(double rpm, double angleDeg) const
+        {
+            ShotOutcome o = EvaluateShotOutcome(launchHeight, distance, radian_t(degree_t(angleDeg)).value(), rpm * velPerRpm);
+            return std::min(o.frontMargin, o.backMargin);
+        }
+    };
+
+    /// Grid padded with a ring of outside nodes that duplicate the boundary coordinates, so regions
+    /// touching the search limits still close along the limits
+    struct PaddedGrid
+    {
+        int nx, ny;                     // Including the ring
+        vector<double> x, y;            // RPM, angle [deg]
+        vector<double> v;               // Margin, v[j * nx + i]
+
+        double At(int i, int j) const { return v[j * nx + i]; }
+        bool Inside(int i, int j) const { return At(i, j) > 0.0; }
+    };
+
+    /// Edge id shared by the two cells on either side of it
+    long long EdgeId(const PaddedGrid& g, int i, int j, CellEdge e)
+    {
+        switch (e)
+        {
+        case c_edgeBottom: return 2LL * (static_cast<long long>(j) * g.nx + i);
+        case c_edgeTop:    return 2LL * (static_cast<long long>(j + 1) * g.nx + i);
+        case c_edgeLeft:   return 2LL * (static_cast<long long>(j) * g.nx + i) + 1;
+        default:           return 2LL * (static_cast<long long>(j) * g.nx + i + 1) + 1;
+        }
+    }
+
+    /// Zero of the margin along a grid edge by Illinois regula falsi, starting from the linear interpolant
+    RegionPoint RefineCrossing(const MarginField& field, const FeasibleRegionOptions& options
+                             , double x0, double y0, double f0, double x1, double y1, double f1)
+    {
+        double a = 0.0, b = 1.0;
+        double fa = f0, fb = f1;
+        double t = fa / (fa - fb);
+        if (x0 != x1 || y0 != y1)
+        {
+            int side = 0;
+            for (int it = 0; it < options.refineIterations; it++)
+            {
+                t = (a * fb - b * fa) / (fb - fa);
+                double ft = field(x0 + t * (x1 - x0), y0 + t * (y1 - y0));
+                if (std::fabs(ft) < options.refineTolerance.value())
+                    break;
+                if ((ft > 0.0) == (fa > 0.0))
+                {
+                    a = t;
+                    fa = ft;
+                    if (side == -1)
+                        fb *= 0.5;
+                    side = -1;
+                }
+                else
+                {
+                    b = t;
+                    fb = ft;
+                    if (side == 1)
+                        fa *= 0.5;
+                    side = 1;
+                }
+            }
+        }
+
+        RegionPoint p;
+        p.rpm = revolutions_per_minute_t(x0 + t * (x1 - x0));
+        p.angle = degree_t(y0 + t * (y1 - y0));
+        return p;
+    }
+}
+
+double FeasibleMargin(const ShooterConfig& config, meter_t distance, revolutions_per_minute_t rpm, degree_t angle)
+{
+    ShotOutcome o = EvaluateShotOutcome(config.launchHeight.value(), distance.value(), radian_t(angle).value()
+                                      , config.RpmToExitVel(rpm).value());
+    return std::min(o.frontMargin, o.backMargin);
+}
+
+FeasibleRegion TraceFeasibleRegion(const ShooterConfig& config, meter_t distance, const FeasibleRegionOptions& options)
+{
+    FeasibleRegion region;
+    region.distance = distance;
+    region.minAngle = config.minAngle;
+    region.maxAngle = config.maxAngle;
+    region.minRpm = options.minRpm;
+    region.maxRpm = options.maxRpm;
+
+    MarginField field;
+    field.launchHeight = config.launchHeight.value();
+    field.distance = distance.value();
+    field.velPerRpm = c_rpmToRadPerSec * config.flywheelRadius.value() / config.SpeedFactor();
+
+    const int nr = std::max(options.rpmSteps, 2);
+    const int na = std::max(options.angleSteps, 2);
+    PaddedGrid g;
+    g.nx = nr + 2;
+    g.ny = na + 2;
+    g.x.resize(g.nx);
+    g.y.resize(g.ny);
+    for (int i = 0; i < g.nx; i++)
+    {
+        int k = std::clamp(i - 1, 0, nr - 1);
+        g.x[i] = options.minRpm.value() + k * (options.maxRpm - options.minRpm).value() / (nr - 1);
+    }
+    for (int j = 0; j < g.ny; j++)
+    {
+        int k = std::clamp(j - 1, 0, na - 1);
+        g.y[j] = config.minAngle.value() + k * (config.maxAngle - config.minAngle).value() / (na - 1);
+    }
+
+    // Sample the margin, one angle row per work item
+    g.v.assign(static_cast<size_t>(g.nx) * g.ny, c_outsideMargin);
+    ParallelFor(static_cast<size_t>(na), options.threads, [&](size_t begin, size_t end, unsigned)
+    {
+        for (size_t row = begin; row < end; row++)
+        {
+            int j = static_cast<int>(row) + 1;
+            for (int i = 1; i <= nr; i++)
+                g.v[j * g.nx + i] = field(g.x[i], g.y[j]);
+        }
+    });
+
+    // Marching squares, every segment joins two edge crossings
+    unordered_map<long long, RegionPoint> crossings;
+    unordered_map<long long, array<long long, 2>> links;    // Edge id -> the edge ids it connects to
+    auto crossing = [&](int i, int j, CellEdge e)
+    {
+        long long id = EdgeId(g, i, j, e);
+        if (crossings.find(id) == crossings.end())
+        {
+            int i0 = i, j0 = j, i1 = i, j1 = j;
+            switch (e)
+            {
+            case c_edgeBottom: i1 = i + 1; break;
+            case c_edgeTop:    j0 = j1 = j + 1; i1 = i + 1; break;
+            case c_edgeLeft:   j1 = j + 1; break;
+            case c_edgeRight:  i0 = i1 = i + 1; j1 = j + 1; break;
+            }
+            crossings[id] = RefineCrossing(field, options, g.x[i0], g.y[j0], g.At(i0, j0), g.x[i1], g.y[j1], g.At(i1, j1));
+        }
+        return id;
+    };
+    auto link = [&](long long a, long long b)
+    {
+        auto add = [&](long long from, long long to)
+        {
+            auto it = links.find(from);
+            if (it == links.end())
+                links[from] = { to, -1 };
+            else
+                it->second[1] = to;
+        };
+        add(a, b);
+        add(b, a);
+    };
+
+    for (int j = 0; j + 1 < g.ny; j++)
+    {
+        for (int i = 0; i + 1 < g.nx; i++)
+        {
+            bool b0 = g.Inside(i, j);
+            bool b1 = g.Inside(i + 1, j);
+            bool b2 = g.Inside(i + 1, j + 1);
+            bool b3 = g.Inside(i, j + 1);
+            int cell = b0 | (b1 << 1) | (b2 << 2) | (b3 << 3);
+            if (cell == 0 || cell == 15)
+                continue;
+
+            if (cell == 5 || cell == 10)
+            {
+                // Saddle, the margin at the cell center decides whether the inside corners connect
+                bool bCenter = field(0.5 * (g.x[i] + g.x[i + 1]), 0.5 * (g.y[j] + g.y[j + 1])) > 0.0;
+                long long eb = crossing(i, j, c_edgeBottom), er = crossing(i, j, c_edgeRight);
+                long long et = crossing(i, j, c_edgeTop), el = crossing(i, j, c_edgeLeft);
+                if (bCenter == (cell == 5))
+                {
+                    link(eb, er);
+                    link(et, el);
+                }
+                else
+                {
+                    link(eb, el);
+                    link(er, et);
+                }
+                continue;
+            }
+
+            long long ends[2];
+            int n = 0;
+            if (b0 != b1) ends[n++] = crossing(i, j, c_edgeBottom);
+            if (b1 != b2) ends[n++] = crossing(i, j, c_edgeRight);
+            if (b3 != b2) ends[n++] = crossing(i, j, c_edgeTop);
+            if (b0 != b3) ends[n++] = crossing(i, j, c_edgeLeft);
+            link(ends[0], ends[1]);
+        }
+    }
+
+    // Walk the links into closed outlines
+    unordered_map<long long, bool> visited;
+    for (const auto& start : links)
+    {
+        if (visited[start.first])
+            continue;
+
+        vector<RegionPoint> polygon;
+        long long prev = -1;
+        long long cur = start.first;
+        while (cur >= 0 && !visited[cur])
+        {
+            visited[cur] = true;
+            polygon.push_back(crossings.at(cur));
+            const array<long long, 2>& next = links.at(cur);
+            long long step = next[0] != prev ? next[0] : next[1];
+            prev = cur;
+            cur = step;
+        }
+
+        double area = 0.0;
+        for (size_t k = 0; k < polygon.size(); k++)
+        {
+            const RegionPoint& p = polygon[k];
+            const RegionPoint& q = polygon[(k + 1) % polygon.size()];
+            area += p.rpm.value() * q.angle.value() - q.rpm.value() * p.angle.value();
+        }
+        region.area += 0.5 * std::fabs(area);
+        region.polygons.push_back(std::move(polygon));
+    }
+
+    return region;
+}
+
+FeasibleRegionCache::FeasibleRegionCache(meter_t resolution, const FeasibleRegionOptions& options)
+    : m_resolution(resolution)
+    , m_options(options)
+{
+}
+
+FeasibleRegion FeasibleRegionCache::Get(const ShooterConfig& config, meter_t distance)
+{
+    long long key = llround((distance / m_resolution).value());
+
+    lock_guard<mutex> lock(m_mutex);
+    if (config.flywheelMass != m_config.flywheelMass || config.flywheelRadius != m_config.flywheelRadius
+     || config.flywheelInertiaFrac != m_config.flywheelInertiaFrac
+     || config.minAngle != m_config.minAngle || config.maxAngle != m_config.maxAngle
+     || config.launchHeight != m_config.launchHeight)
+    {
+        m_regions.clear();
+        m_config = config;
+    }
+
+    auto it = m_regions.find(key);
+    CountSolverEvent(it == m_regions.end() ? c_statCacheMisses : c_statCacheHits);
+    if (it == m_regions.end())
+        it = m_regions.emplace(key, TraceFeasibleRegion(m_config, static_cast<double>(key) * m_resolution, m_options)).first;
+    return it->second;
+}
+
+void FeasibleRegionCache::Clear()
+{
+    lock_guard<mutex> lock(m_mutex);
+    m_regions.clear();
+}
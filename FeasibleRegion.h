@@ -0,0 +1,66 @@
+/// Feasible (RPM, hood angle) region per distance
+///
+/// SolveShot() picks one (RPM, angle) pair that lands on the requested target point, but every pair
+/// whose arc clears the front rim and drops inside the cone opening scores. The region is traced by
+/// sampling the rim margin on an RPM x angle grid, extracting its zero contour with marching squares
+/// and refining each contour crossing along its grid edge by root finding.
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "ShotSolver.h"
+
+struct RegionPoint
+{
+    revolutions_per_minute_t rpm = revolutions_per_minute_t(0.0);
+    degree_t angle = degree_t(0.0);
+};
+
+struct FeasibleRegionOptions
+{
+    revolutions_per_minute_t minRpm = revolutions_per_minute_t(1000.0);
+    revolutions_per_minute_t maxRpm = revolutions_per_minute_t(8000.0);
+    int rpmSteps = 96;                  //!< Grid nodes along RPM
+    int angleSteps = 64;                //!< Grid nodes along the hood angle, between config.minAngle and maxAngle
+    int refineIterations = 40;          //!< Regula falsi steps per contour crossing
+    meter_t refineTolerance = meter_t(1e-6);    //!< Stop refining once the margin is this close to zero
+    unsigned threads = 0;               //!< 0 uses std::thread::hardware_concurrency()
+};
+
+struct FeasibleRegion
+{
+    meter_t distance = meter_t(0.0);
+    degree_t minAngle = degree_t(0.0);  //!< Angle range that was searched
+    degree_t maxAngle = degree_t(0.0);
+    revolutions_per_minute_t minRpm = revolutions_per_minute_t(0.0);
+    revolutions_per_minute_t maxRpm = revolutions_per_minute_t(0.0);
+    std::vector<std::vector<RegionPoint>> polygons;     //!< Closed outlines, the last point connects back to the first
+    double area = 0.0;                  //!< Total enclosed area [rpm * deg], a measure of how forgiving the distance is
+};
+
+/// Margin of the drag free arc to the nearer of the front rim and the far side of the cone opening,
+/// positive inside the feasible region [m]
+double FeasibleMargin(const ShooterConfig& config, meter_t distance, revolutions_per_minute_t rpm, degree_t angle);
+
+FeasibleRegion TraceFeasibleRegion(const ShooterConfig& config, meter_t distance, const FeasibleRegionOptions& options = FeasibleRegionOptions());
+
+/// Thread safe cache of traced regions, keyed by distance quantized to the resolution. A different
+/// config than the cached entries were traced with clears the cache.
+class FeasibleRegionCache
+{
+public:
+    explicit FeasibleRegionCache(meter_t resolution = meter_t(0.01), const FeasibleRegionOptions& options = FeasibleRegionOptions());
+
+    FeasibleRegion Get(const ShooterConfig& config, meter_t distance);
+    void Clear();
+
+private:
+    std::mutex m_mutex;
+    meter_t m_resolution;
+    FeasibleRegionOptions m_options;
+    ShooterConfig m_config;
+    std::map<long long, FeasibleRegion> m_regions;
+};
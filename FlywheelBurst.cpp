@@ -0,0 +1,190 @@
+#include "FlywheelBurst.h"
+#include "Parallel.h"
+#include "RpmWindow.h"
+
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+namespace
+{
+    /// Flywheel plus motors reduced to SI doubles
+    struct FlywheelDynamics
+    {
+        double inertia;         // [kg m^2]
+        double freeSpeed;       // At the flywheel [rad/s]
+        double timeConstant;    // inertia / (stall torque / free speed) [s]
+        double limitSpeed;      // Below this the current limit caps the torque [rad/s]
+        double limitAccel;      // Angular acceleration at the current limit [rad/s^2]
+        double dropFactor;      // Flywheel speed after a shot over the speed before it
+        double velPerRadPerSec; // Exit velocity per flywheel speed [m/s per rad/s]
+
+        /// Full voltage spin up for t seconds, stopping at the setpoint
+        double Recover(double w0, double t, double setpoint) const
+        {
+            if (w0 < limitSpeed)
+            {
+                double tLimit = (limitSpeed - w0) / limitAccel;
+                if (t <= tLimit)
+                    return std::min(w0 + limitAccel * t, setpoint);
+                w0 = limitSpeed;
+                t -= tLimit;
+            }
+            double w = freeSpeed + (w0 - freeSpeed) * exp(-t / timeConstant);
+            return std::min(w, setpoint);
+        }
+
+        /// Time to spin up from w0 to w1, infinite if w1 is at or above the free speed
+        double TimeToReach(double w0, double w1) const
+        {
+            if (w1 >= freeSpeed)
+                return numeric_limits<double>::infinity();
+            if (w0 >= w1)
+                return 0.0;
+            double t = 0.0;
+            if (w0 < limitSpeed)
+            {
+                if (w1 <= limitSpeed)
+                    return (w1 - w0) / limitAccel;
+                t = (limitSpeed - w0) / limitAccel;
+                w0 = limitSpeed;
+            }
+            return t + timeConstant * log((freeSpeed - w0) / (freeSpeed - w1));
+        }
+    };
+
+    FlywheelDynamics MakeDynamics(const ShooterConfig& config, const FlywheelMotor& motor)
+    {
+        double speedFactor = config.SpeedFactor();
+        double stallTorque = motor.motorCount * motor.stallTorque.value() / motor.gearRatio;
+        double limitTorque = stallTorque * std::min((motor.currentLimit / motor.stallCurrent).value(), 1.0);
+
+        FlywheelDynamics f;
+        f.inertia = config.FlywheelInertia().value();
+        f.freeSpeed = radians_per_second_t(motor.freeSpeed).value() * motor.gearRatio;
+        f.timeConstant = f.inertia * f.freeSpeed / stallTorque;
+        f.limitSpeed = f.freeSpeed * (1.0 - limitTorque / stallTorque);
+        f.limitAccel = limitTorque / f.inertia;
+        f.dropFactor = 2.0 / speedFactor;
+        f.velPerRadPerSec = config.flywheelRadius.value() / speedFactor;
+        return f;
+    }
+}
+
+BurstResult SimulateBurst(const ShooterConfig& config, meter_t distance, const FlywheelMotor& motor, const BurstOptions& options)
+{
+    BurstResult r;
+    r.setpoint = SolveShot(config, distance, options.targetDist, options.heightAboveHub, options.targetHeight);
+    if (!isfinite(r.setpoint.rpm.value()))
+        return r;
+
+    const FlywheelDynamics f = MakeDynamics(config, motor);
+    const double h0 = config.launchHeight.value();
+    const double angle = radian_t(r.setpoint.angleInit).value();
+    const double setpoint = radians_per_second_t(r.setpoint.rpm).value();
+    r.bSetpointReachable = setpoint < f.freeSpeed;
+
+    const double nominalEntry = EvaluateShotOutcome(h0, distance.value(), angle, setpoint * f.velPerRadPerSec).entryDist;
+    const double dt = options.feedInterval.value();
+
+    // Event driven: the state only changes at each ball, the spin up in between is closed form
+    double w = setpoint;
+    r.shots.resize(std::max(options.shots, 0));
+    for (size_t k = 0; k < r.shots.size(); k++)
+    {
+        BurstShot& s = r.shots[k];
+        double vel = w * f.velPerRadPerSec;
+        ShotOutcome o = EvaluateShotOutcome(h0, distance.value(), angle, vel);
+        double after = w * f.dropFactor;
+
+        s.time = second_t(k * dt);
+        s.rpm = radians_per_second_t(w);
+        s.exitVel = meters_per_second_t(vel);
+        s.energy = units::energy::joule_t(0.5 * f.inertia * (w * w - after * after));
+        s.landingError = meter_t(o.bReaches ? o.entryDist - nominalEntry : -distance.value());
+        s.bHit = o.bHit;
+
+        w = k + 1 < r.shots.size() ? f.Recover(after, dt, setpoint) : after;
+    }
+
+    r.recoveryTime = second_t(r.shots.empty() ? 0.0 : f.TimeToReach(w, setpoint));
+    return r;
+}
+
+second_t FlywheelSpinUpTime(const ShooterConfig& config, const FlywheelMotor& motor, revolutions_per_minute_t from, revolutions_per_minute_t to)
+{
+    return second_t(MakeDynamics(config, motor).TimeToReach(radians_per_second_t(from).value(), radians_per_second_t(to).value()));
+}
+
+second_t FlywheelShotRecoveryTime(const ShooterConfig& config, const FlywheelMotor& motor, revolutions_per_minute_t rpm)
+{
+    return FlywheelBurstRecoveryTime(config, motor, rpm, 1, second_t(0.0));
+}
+
+second_t FlywheelBurstRecoveryTime(const ShooterConfig& config, const FlywheelMotor& motor, revolutions_per_minute_t rpm, int shots, second_t feedInterval)
+{
+    if (shots <= 0)
+        return second_t(0.0);
+
+    const FlywheelDynamics f = MakeDynamics(config, motor);
+    const double setpoint = radians_per_second_t(rpm).value();
+    double w = setpoint;
+    for (int k = 0; k + 1 < shots; k++)
+        w = f.Recover(w * f.dropFactor, feedInterval.value(), setpoint);
+    return second_t(f.TimeToReach(w * f.dropFactor, setpoint));
+}
+
+FireRate MaxSustainedFireRate(const ShooterConfig& config, meter_t distance, const FlywheelMotor& motor, const BurstOptions& options)
+{
+    FireRate rate;
+    rate.distance = distance;
+    rate.flywheelMass = config.flywheelMass;
+    rate.flywheelRadius = config.flywheelRadius;
+
+    BurstResult burst = SimulateBurst(config, distance, motor, options);
+    rate.setpointRpm = burst.setpoint.rpm;
+    while (rate.burstHits < static_cast<int>(burst.shots.size()) && burst.shots[rate.burstHits].bHit)
+        rate.burstHits++;
+    if (!burst.bSetpointReachable)
+        return rate;
+
+    vector<RpmWindow> window;
+    SolveRpmWindowBatch(config, vector<meter_t>{ distance }, vector<degree_t>{ burst.setpoint.angleInit }, options.targetDist, options.targetHeight, window);
+    if (!window[0].bValid)
+        return rate;
+    rate.minRpm = window[0].minRpm;
+
+    // Steady state: every ball meets the lowest scoring speed, so the period is the spin up from the droop back to it
+    const FlywheelDynamics f = MakeDynamics(config, motor);
+    double low = radians_per_second_t(rate.minRpm).value();
+    double period = f.TimeToReach(low * f.dropFactor, low);
+    rate.maxFireRate = units::frequency::hertz_t(period > 0.0 ? 1.0 / period : numeric_limits<double>::infinity());
+    return rate;
+}
+
+vector<FireRate> SweepMaxFireRate(const ShooterConfig& config
+                                , const vector<meter_t>& distances
+                                , const vector<kilogram_t>& flywheelMasses
+                                , const vector<meter_t>& flywheelRadii
+                                , const FlywheelMotor& motor
+                                , const BurstOptions& options
+                                , unsigned threads)
+{
+    const size_t masses = flywheelMasses.size();
+    const size_t radii = flywheelRadii.size();
+    vector<FireRate> results(distances.size() * masses * radii);
+
+    ParallelFor(results.size(), threads, [&](size_t begin, size_t end, unsigned)
+    {
+        for (size_t n = begin; n < end; n++)
+        {
+            ShooterConfig c = config;
+            c.flywheelRadius = flywheelRadii[n % radii];
+            c.flywheelMass = flywheelMasses[(n / radii) % masses];
+            results[n] = MaxSustainedFireRate(c, distances[n / (radii * masses)], motor, options);
+        }
+    });
+
+    return results;
+}
@@ -0,0 +1,91 @@
+/// Flywheel speed droop and recovery during rapid fire bursts
+///
+/// Each ball leaves with the exit velocity the flywheel speed it meets gives (see FlywheelSpeedFactor()),
+/// and the flywheel is left turning at twice the exit velocity at its surface, i.e. 2 / FlywheelSpeedFactor()
+/// of its speed before the shot. The difference is the energy handed to the ball. Between balls the
+/// motors run at full voltage until the setpoint is reached again, at the current limited torque below
+/// the speed where the linear DC torque-speed curve drops under it and on the curve above. Both pieces
+/// have closed form solutions, so a burst costs a handful of exp/log calls per ball and mass x radius
+/// sweeps stay cheap.
+
+#pragma once
+
+#include <vector>
+
+#include "ShotSolver.h"
+
+/// DC motor(s) driving the flywheel, defaults are one Kraken X60 with a 60 A stator current limit
+struct FlywheelMotor
+{
+    revolutions_per_minute_t freeSpeed = revolutions_per_minute_t(6000.0);
+    units::torque::newton_meter_t stallTorque = units::torque::newton_meter_t(7.09);
+    units::current::ampere_t stallCurrent = units::current::ampere_t(366.0);
+    units::current::ampere_t currentLimit = units::current::ampere_t(60.0);   //!< Caps the torque at low speed, set to stallCurrent for none
+    int motorCount = 1;
+    double gearRatio = 1.0;             //!< Flywheel turns per motor turn
+};
+
+struct BurstOptions
+{
+    int shots = 5;
+    second_t feedInterval = second_t(0.1);  //!< Time between balls reaching the flywheel
+    meter_t targetDist = defaultTargetDist;
+    meter_t heightAboveHub = defaultHeightAboveHub;
+    meter_t targetHeight = defaultTargetHeight;
+};
+
+struct BurstShot
+{
+    second_t time = second_t(0.0);                      //!< Since the first ball
+    revolutions_per_minute_t rpm = revolutions_per_minute_t(0.0);  //!< Flywheel speed the ball meets
+    meters_per_second_t exitVel = meters_per_second_t(0.0);
+    units::energy::joule_t energy = units::energy::joule_t(0.0);   //!< Taken out of the flywheel by this ball
+    meter_t landingError = meter_t(0.0);                //!< Rim height crossing relative to a ball at the setpoint, negative is short, -distance if it never gets to rim height
+    bool bHit = false;
+};
+
+struct BurstResult
+{
+    ShotSolution setpoint;                              //!< Stationary solution the burst is fired at
+    std::vector<BurstShot> shots;
+    second_t recoveryTime = second_t(0.0);              //!< After the last ball until the flywheel is back at the setpoint
+    bool bSetpointReachable = false;                    //!< False if the setpoint is above the motors' free speed
+};
+
+/// Simulates one burst starting at the setpoint for the given distance
+BurstResult SimulateBurst(const ShooterConfig& config, meter_t distance, const FlywheelMotor& motor, const BurstOptions& options = BurstOptions());
+
+/// Full voltage spin up time between two flywheel speeds, infinite if the target is not below the free speed
+second_t FlywheelSpinUpTime(const ShooterConfig& config, const FlywheelMotor& motor, revolutions_per_minute_t from, revolutions_per_minute_t to);
+
+/// Time for the flywheel to get back to rpm after one ball goes through
+second_t FlywheelShotRecoveryTime(const ShooterConfig& config, const FlywheelMotor& motor, revolutions_per_minute_t rpm);
+
+/// Time for the flywheel to get back to rpm after the last ball of a burst fired from rpm, the same
+/// flywheel model as SimulateBurst() without the shot solves
+second_t FlywheelBurstRecoveryTime(const ShooterConfig& config, const FlywheelMotor& motor, revolutions_per_minute_t rpm, int shots, second_t feedInterval);
+
+struct FireRate
+{
+    meter_t distance = meter_t(0.0);
+    kilogram_t flywheelMass = kilogram_t(0.0);
+    meter_t flywheelRadius = meter_t(0.0);
+    revolutions_per_minute_t setpointRpm = revolutions_per_minute_t(0.0);
+    revolutions_per_minute_t minRpm = revolutions_per_minute_t(0.0);   //!< Lowest flywheel speed that still scores
+    units::frequency::hertz_t maxFireRate = units::frequency::hertz_t(0.0);   //!< Balls per second that can be sustained indefinitely
+    int burstHits = 0;                  //!< Balls in a row that score in a burst of options.shots at options.feedInterval
+};
+
+/// Highest steady fire rate at which every ball still meets a scoring flywheel speed: in steady state each
+/// ball meets exactly the lowest scoring speed, and the interval is the time to recover back to it.
+FireRate MaxSustainedFireRate(const ShooterConfig& config, meter_t distance, const FlywheelMotor& motor, const BurstOptions& options = BurstOptions());
+
+/// Sweep over flywheel mass and radius for each distance, evaluated in parallel
+/// \return Entries ordered by distance, then mass, then radius
+std::vector<FireRate> SweepMaxFireRate(const ShooterConfig& config
+                                     , const std::vector<meter_t>& distances
+                                     , const std::vector<kilogram_t>& flywheelMasses
+                                     , const std::vector<meter_t>& flywheelRadii
+                                     , const FlywheelMotor& motor
+                                     , const BurstOptions& options = BurstOptions()
+                                     , unsigned threads = 0);
@@ -0,0 +1,205 @@
+#include "FlywheelControl.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace
+{
+    constexpr size_t c_blockLanes = 64;
+    constexpr double c_motorNominalVoltage = 12.0;  // Voltage the motor free speed and stall figures are quoted at
+    constexpr double c_radPerSecToRpm = 60.0 / (2.0 * 3.141592653589793);
+
+    /// Plant constants in SI doubles, all referred to the flywheel shaft except the per motor current
+    struct PlantConstants
+    {
+        double inertia;         // [kg m^2]
+        double emfPerRadPerSec; // Motor back EMF per flywheel speed [V per rad/s]
+        double resistance;      // Motor winding [ohm]
+        double torquePerAmp;    // Flywheel torque per amp in each motor [Nm/A]
+        double currentLimit;    // Per motor stator current [A]
+        double motorCount;
+        double friction;        // [Nm]
+        double openCircuit;     // [V]
+        double batteryResistance;   // [ohm]
+    };
+
+    PlantConstants MakePlant(const ShooterConfig& config, const FlywheelPlant& plant)
+    {
+        const FlywheelMotor& m = plant.motor;
+        PlantConstants p;
+        p.inertia = config.FlywheelInertia().value();
+        p.emfPerRadPerSec = c_motorNominalVoltage / (radians_per_second_t(m.freeSpeed).value() * m.gearRatio);
+        p.resistance = c_motorNominalVoltage / m.stallCurrent.value();
+        p.torquePerAmp = m.stallTorque.value() / m.stallCurrent.value() / m.gearRatio;
+        p.currentLimit = m.currentLimit.value();
+        p.motorCount = m.motorCount;
+        p.friction = plant.frictionTorque.value();
+        p.openCircuit = plant.batteryVoltage.value();
+        p.batteryResistance = plant.batteryResistance.value();
+        return p;
+    }
+
+    /// Steps one block of lanes through the whole run, lane k simulates gains[k] against targets[k]
+    void SimulateBlock(const PlantConstants& p, const ControlSimOptions& options
+                     , const FlywheelGains* gains, const double* targets, size_t lanes, FlywheelStepMetrics* out)
+    {
+        const double dt = options.timeStep.value();
+        const int steps = static_cast<int>(std::ceil(options.duration.value() / dt));
+        const double initial = options.initialRpm.value();
+        const double band = options.tolerance.value();
+
+        // Plant and controller state
+        double w[c_blockLanes], bus[c_blockLanes], integral[c_blockLanes], prevRpm[c_blockLanes];
+        // Metric trackers
+        double t10[c_blockLanes], t90[c_blockLanes], peak[c_blockLanes], lastOutside[c_blockLanes], inBand[c_blockLanes], minBus[c_blockLanes];
+
+        for (size_t k = 0; k < lanes; k++)
+        {
+            w[k] = initial / c_radPerSecToRpm;
+            bus[k] = p.openCircuit;
+            integral[k] = 0.0;
+            prevRpm[k] = initial;
+            t10[k] = t90[k] = -1.0;
+            peak[k] = 0.0;
+            lastOutside[k] = 0.0;
+            inBand[k] = 0.0;
+            minBus[k] = p.openCircuit;
+        }
+
+        for (int s = 1; s <= steps; s++)
+        {
+            const double t = s * dt;
+            for (size_t k = 0; k < lanes; k++)
+            {
+                const FlywheelGains& g = gains[k];
+                const double target = targets[k];
+
+                // Controller, sampled at the start of the period
+                double rpm = w[k] * c_radPerSecToRpm;
+                double error = target - rpm;
+                double command = (target > 0.0 ? g.kS : 0.0) + g.kV * target + g.kP * error + g.kI * integral[k] - g.kD * (rpm - prevRpm[k]) / dt;
+                double volts = std::clamp(command, -bus[k], bus[k]);
+                // Anti-windup: hold the integral while saturated unless the error would pull the output back in
+                bool bSaturated = volts != command;
+                integral[k] += (!bSaturated || error * command < 0.0) ? error * dt : 0.0;
+                prevRpm[k] = rpm;
+
+                // Plant, the electrical side settles much faster than the 1 ms step so it is quasi static
+                double current = std::clamp((volts - p.emfPerRadPerSec * w[k]) / p.resistance, -p.currentLimit, p.currentLimit);
+                double torque = p.motorCount * p.torquePerAmp * current - (w[k] > 0.0 ? p.friction : 0.0);
+                w[k] = std::max(w[k] + torque / p.inertia * dt, 0.0);
+
+                double supply = p.motorCount * current * volts / bus[k];
+                bus[k] = p.openCircuit - p.batteryResistance * supply;
+                minBus[k] = std::min(minBus[k], bus[k]);
+
+                // Metrics on the speed at the end of the period
+                rpm = w[k] * c_radPerSecToRpm;
+                double step = target - initial;
+                double progress = step != 0.0 ? (rpm - initial) / step : 1.0;
+                t10[k] = (t10[k] < 0.0 && progress >= 0.1) ? t : t10[k];
+                t90[k] = (t90[k] < 0.0 && progress >= 0.9) ? t : t90[k];
+                peak[k] = std::max(peak[k], progress);
+                bool bInBand = std::fabs(rpm - target) <= band;
+                inBand[k] += bInBand ? dt : 0.0;
+                lastOutside[k] = bInBand ? lastOutside[k] : t;
+            }
+        }
+
+        const double duration = steps * dt;
+        for (size_t k = 0; k < lanes; k++)
+        {
+            FlywheelStepMetrics& m = out[k];
+            m.gains = gains[k];
+            m.target = revolutions_per_minute_t(targets[k]);
+            m.riseTime = second_t(t10[k] >= 0.0 && t90[k] >= 0.0 ? t90[k] - t10[k] : duration);
+            m.overshoot = std::max(peak[k] - 1.0, 0.0);
+            m.settlingTime = second_t(lastOutside[k] >= duration ? duration : lastOutside[k]);
+            m.timeInTolerance = second_t(inBand[k]);
+            m.finalError = revolutions_per_minute_t(w[k] * c_radPerSecToRpm - targets[k]);
+            m.minBusVoltage = units::voltage::volt_t(minBus[k]);
+        }
+    }
+}
+
+vector<revolutions_per_minute_t> ShotRpmTargets(const ShooterConfig& config, const vector<meter_t>& distances)
+{
+    vector<revolutions_per_minute_t> targets(distances.size());
+    for (size_t i = 0; i < distances.size(); i++)
+        targets[i] = SolveShot(config, distances[i], defaultTargetDist).rpm;
+    return targets;
+}
+
+vector<FlywheelStepMetrics> SimulateFlywheelControlBatch(const ShooterConfig& config
+                                                       , const FlywheelPlant& plant
+                                                       , const vector<FlywheelGains>& gains
+                                                       , const vector<revolutions_per_minute_t>& targets
+                                                       , const ControlSimOptions& options)
+{
+    const PlantConstants p = MakePlant(config, plant);
+    const size_t count = gains.size() * targets.size();
+    vector<FlywheelStepMetrics> results(count);
+
+    // Expand to one (gains, target) pair per lane
+    vector<FlywheelGains> laneGains(count);
+    vector<double> laneTargets(count);
+    for (size_t n = 0; n < count; n++)
+    {
+        laneGains[n] = gains[n / targets.size()];
+        laneTargets[n] = targets[n % targets.size()].value();
+    }
+
+    size_t blocks = (count + c_blockLanes - 1) / c_blockLanes;
+    ParallelFor(blocks, options.threads, [&](size_t begin, size_t end, unsigned)
+    {
+        for (size_t b = begin; b < end; b++)
+        {
+            size_t first = b * c_blockLanes;
+            size_t lanes = std::min(c_blockLanes, count - first);
+            SimulateBlock(p, options, &laneGains[first], &laneTargets[first], lanes, &results[first]);
+        }
+    });
+
+    return results;
+}
+
+vector<GainMapCell> BuildGainSensitivityMap(const ShooterConfig& config
+                                          , const FlywheelPlant& plant
+                                          , const FlywheelGains& base
+                                          , const vector<double>& kPValues
+                                          , const vector<double>& kVValues
+                                          , const vector<revolutions_per_minute_t>& targets
+                                          , const ControlSimOptions& options)
+{
+    vector<FlywheelGains> gains(kPValues.size() * kVValues.size(), base);
+    for (size_t i = 0; i < kPValues.size(); i++)
+    {
+        for (size_t j = 0; j < kVValues.size(); j++)
+        {
+            gains[i * kVValues.size() + j].kP = kPValues[i];
+            gains[i * kVValues.size() + j].kV = kVValues[j];
+        }
+    }
+
+    vector<FlywheelStepMetrics> runs = SimulateFlywheelControlBatch(config, plant, gains, targets, options);
+
+    vector<GainMapCell> cells(gains.size());
+    for (size_t c = 0; c < cells.size(); c++)
+    {
+        GainMapCell& cell = cells[c];
+        cell.gains = gains[c];
+        cell.minTimeInTolerance = options.duration;
+        for (size_t t = 0; t < targets.size(); t++)
+        {
+            const FlywheelStepMetrics& m = runs[c * targets.size() + t];
+            cell.worstRiseTime = std::max(cell.worstRiseTime, m.riseTime);
+            cell.worstOvershoot = std::max(cell.worstOvershoot, m.overshoot);
+            cell.worstSettlingTime = std::max(cell.worstSettlingTime, m.settlingTime);
+            cell.minTimeInTolerance = std::min(cell.minTimeInTolerance, m.timeInTolerance);
+        }
+    }
+    return cells;
+}
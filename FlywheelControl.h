@@ -0,0 +1,82 @@
+/// Closed loop flywheel control simulation
+///
+/// Feedforward plus PID driving the FlywheelMotor model from FlywheelBurst.h at 1 kHz. The plant adds
+/// the battery internal resistance, so heavy current draw sags the bus voltage the controller has to
+/// work with, and the flywheel inertia comes from the shooter config like everywhere else. Many
+/// (gains, target) pairs are stepped in lock step in structure of arrays blocks, so a full gain
+/// sensitivity map is quick enough to recompute while tuning.
+
+#pragma once
+
+#include <vector>
+
+#include "FlywheelBurst.h"
+
+struct FlywheelPlant
+{
+    FlywheelMotor motor;
+    units::voltage::volt_t batteryVoltage = units::voltage::volt_t(12.5);         //!< Open circuit
+    units::impedance::ohm_t batteryResistance = units::impedance::ohm_t(0.02);    //!< Internal plus wiring
+    units::torque::newton_meter_t frictionTorque = units::torque::newton_meter_t(0.02);   //!< Coulomb friction at the flywheel
+};
+
+/// Output voltage = kS + kV * target + kP * error + kI * integral(error) - kD * d(rpm)/dt, clamped to the bus voltage.
+/// Gains are per flywheel RPM to match the rest of the solver.
+struct FlywheelGains
+{
+    double kS = 0.25;       //!< [V]
+    double kV = 0.002;      //!< [V/rpm]
+    double kP = 0.004;      //!< [V/rpm]
+    double kI = 0.0;        //!< [V/(rpm s)]
+    double kD = 0.0;        //!< [V s/rpm]
+};
+
+struct ControlSimOptions
+{
+    second_t duration = second_t(1.0);
+    second_t timeStep = second_t(0.001);                //!< Controller and plant update period
+    revolutions_per_minute_t initialRpm = revolutions_per_minute_t(0.0);
+    revolutions_per_minute_t tolerance = revolutions_per_minute_t(50.0);   //!< +/- band that counts as at speed
+    unsigned threads = 0;                               //!< 0 uses std::thread::hardware_concurrency()
+};
+
+struct FlywheelStepMetrics
+{
+    FlywheelGains gains;
+    revolutions_per_minute_t target = revolutions_per_minute_t(0.0);
+    second_t riseTime = second_t(0.0);                  //!< 10% to 90% of the step, the duration if never reached
+    double overshoot = 0.0;                             //!< Peak past the target as a fraction of the step
+    second_t settlingTime = second_t(0.0);              //!< Last entry into the tolerance band, the duration if it ends outside
+    second_t timeInTolerance = second_t(0.0);           //!< Total time spent inside the tolerance band
+    revolutions_per_minute_t finalError = revolutions_per_minute_t(0.0);
+    units::voltage::volt_t minBusVoltage = units::voltage::volt_t(0.0);
+};
+
+/// Flywheel setpoints SolveShot() asks for at each distance
+std::vector<revolutions_per_minute_t> ShotRpmTargets(const ShooterConfig& config, const std::vector<meter_t>& distances);
+
+/// Every gain set against every target, results[g * targets.size() + t]
+std::vector<FlywheelStepMetrics> SimulateFlywheelControlBatch(const ShooterConfig& config
+                                                            , const FlywheelPlant& plant
+                                                            , const std::vector<FlywheelGains>& gains
+                                                            , const std::vector<revolutions_per_minute_t>& targets
+                                                            , const ControlSimOptions& options = ControlSimOptions());
+
+/// One cell of the gain map, the worst case of each metric over all targets
+struct GainMapCell
+{
+    FlywheelGains gains;
+    second_t worstRiseTime = second_t(0.0);
+    double worstOvershoot = 0.0;
+    second_t worstSettlingTime = second_t(0.0);
+    second_t minTimeInTolerance = second_t(0.0);
+};
+
+/// Varies kP and kV around the base gains, cells[i * kVValues.size() + j] uses kPValues[i] and kVValues[j]
+std::vector<GainMapCell> BuildGainSensitivityMap(const ShooterConfig& config
+                                               , const FlywheelPlant& plant
+                                               , const FlywheelGains& base
+                                               , const std::vector<double>& kPValues
+                                               , const std::vector<double>& kVValues
+                                               , const std::vector<revolutions_per_minute_t>& targets
+                                               , const ControlSimOptions& options = ControlSimOptions());
@@ -0,0 +1,152 @@
+/// Flywheel moment of inertia from its parts
+///
+/// The RPM formula only needs the flywheel inertia as a fraction of M R^2, with M the total spinning
+/// mass and R the radius the ball rides on. Instead of hard coding that fraction, a flywheel is
+/// described as a stack of primitive parts (wheels, hubs, spokes, bolts) sharing one axis, and the
+/// fraction is computed from them. Everything is constexpr, so fixed geometries like the SDS flywheel
+/// below are evaluated at compile time, and sweeps can build geometries at run time with the same code.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "BallisticsConstants.h"
+
+using kilogram_square_meter_t = units::unit_t<units::compound_unit<units::mass::kilograms, units::squared<units::length::meters>>>;
+
+/// One part of the flywheel, all parts turn about the same axis
+struct FlywheelPart
+{
+    enum class Shape
+    {
+        HollowCylinder,     //!< Annulus between innerRadius and outerRadius, solid with innerRadius = 0
+        RadialRod,          //!< Thin rod along a radius from innerRadius to outerRadius, e.g. a spoke
+        ThinRing,           //!< All mass at outerRadius, e.g. a tread or a circle of bolts
+    };
+
+    Shape shape = Shape::HollowCylinder;
+    kilogram_t mass = kilogram_t(0.0);      //!< Of one copy
+    meter_t innerRadius = meter_t(0.0);
+    meter_t outerRadius = meter_t(0.0);
+    int count = 1;                          //!< Identical copies, e.g. the number of spokes
+
+    static constexpr FlywheelPart HollowCylinder(kilogram_t mass, meter_t outerRadius, meter_t innerRadius)
+    {
+        return FlywheelPart{Shape::HollowCylinder, mass, innerRadius, outerRadius, 1};
+    }
+
+    static constexpr FlywheelPart SolidCylinder(kilogram_t mass, meter_t radius)
+    {
+        return HollowCylinder(mass, radius, meter_t(0.0));
+    }
+
+    /// Hollow cylinder with the mass from its material density and axial width
+    static constexpr FlywheelPart HollowCylinderOf(units::density::kilograms_per_cubic_meter_t density, meter_t width, meter_t outerRadius, meter_t innerRadius)
+    {
+        return HollowCylinder(density * 3.14159265358979 * (outerRadius * outerRadius - innerRadius * innerRadius) * width, outerRadius, innerRadius);
+    }
+
+    static constexpr FlywheelPart Spokes(int count, kilogram_t massEach, meter_t innerRadius, meter_t outerRadius)
+    {
+        return FlywheelPart{Shape::RadialRod, massEach, innerRadius, outerRadius, count};
+    }
+
+    static constexpr FlywheelPart Ring(kilogram_t mass, meter_t radius)
+    {
+        return FlywheelPart{Shape::ThinRing, mass, radius, radius, 1};
+    }
+
+    static constexpr FlywheelPart PointMasses(int count, kilogram_t massEach, meter_t radius)
+    {
+        return FlywheelPart{Shape::ThinRing, massEach, radius, radius, count};
+    }
+
+    constexpr kilogram_t TotalMass() const { return mass * count; }
+
+    constexpr kilogram_square_meter_t Inertia() const
+    {
+        const meter_t ri = innerRadius;
+        const meter_t ro = outerRadius;
+        switch (shape)
+        {
+        case Shape::HollowCylinder:
+            return TotalMass() * (ro * ro + ri * ri) / 2.0;
+        case Shape::RadialRod:
+            return TotalMass() * (ri * ri + ri * ro + ro * ro) / 3.0;
+        case Shape::ThinRing:
+            break;
+        }
+        return TotalMass() * ro * ro;
+    }
+};
+
+constexpr size_t c_maxFlywheelParts = 8;
+
+/// Parts stacked on one shaft. Fixed capacity so it can be built and evaluated in constant expressions.
+struct FlywheelGeometry
+{
+    std::array<FlywheelPart, c_maxFlywheelParts> parts{};
+    size_t partCount = 0;
+    meter_t contactRadius = meter_t(0.0);   //!< Radius the ball rides on, the largest outer radius if left at 0
+
+    /// Appends a part, parts past c_maxFlywheelParts are ignored
+    constexpr FlywheelGeometry& Add(const FlywheelPart& part)
+    {
+        if (partCount < c_maxFlywheelParts)
+            parts[partCount++] = part;
+        return *this;
+    }
+
+    constexpr kilogram_t Mass() const
+    {
+        kilogram_t m = kilogram_t(0.0);
+        for (size_t i = 0; i < partCount; i++)
+            m += parts[i].TotalMass();
+        return m;
+    }
+
+    constexpr kilogram_square_meter_t Inertia() const
+    {
+        kilogram_square_meter_t moi = kilogram_square_meter_t(0.0);
+        for (size_t i = 0; i < partCount; i++)
+            moi += parts[i].Inertia();
+        return moi;
+    }
+
+    constexpr meter_t Radius() const
+    {
+        if (contactRadius > meter_t(0.0))
+            return contactRadius;
+        meter_t r = meter_t(0.0);
+        for (size_t i = 0; i < partCount; i++)
+            r = parts[i].outerRadius > r ? parts[i].outerRadius : r;
+        return r;
+    }
+
+    /// Inertia over Mass() * Radius()^2, what the RPM formula takes in place of flywheelRotInertiaFrac
+    constexpr scalar_t InertiaFraction() const
+    {
+        const meter_t r = Radius();
+        const kilogram_t m = Mass();
+        return m > kilogram_t(0.0) && r > meter_t(0.0) ? scalar_t(Inertia() / (m * r * r)) : flywheelRotInertiaFrac;
+    }
+};
+
+template <class... Parts>
+constexpr FlywheelGeometry MakeFlywheel(const Parts&... parts)
+{
+    FlywheelGeometry g;
+    (g.Add(parts), ...);
+    return g;
+}
+
+/// SDS brass hollow flywheel, from MoiHollowCyl.xlsx: 1.54 lb, 3.95 in across, 0.835 in wall.
+/// The spec sheet MOI is 4 lb in^2.
+constexpr FlywheelGeometry c_sdsHollowFlywheel = MakeFlywheel(
+    FlywheelPart::HollowCylinder(pound_t(1.54), inch_t(3.95 / 2.0), inch_t(3.95 / 2.0 - 0.835)));
+
+/// The default flywheel, matches c_flywheelMass, c_flywheelRadius and flywheelRotInertiaFrac
+constexpr FlywheelGeometry c_defaultFlywheel = MakeFlywheel(FlywheelPart::SolidCylinder(c_flywheelMass, c_flywheelRadius));
+
+static_assert(c_defaultFlywheel.InertiaFraction() - flywheelRotInertiaFrac < 1e-12 && flywheelRotInertiaFrac - c_defaultFlywheel.InertiaFraction() < 1e-12, "Solid cylinder is 1/2 M R^2");
@@ -0,0 +1,206 @@
+#include "HeightPolicy.h"
+#include "Parallel.h"
+#include "RpmWindow.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+using namespace std;
+
+namespace
+{
+    constexpr double c_infeasibleCost = 1.0e6;
+    constexpr double c_goldenRatio = 0.6180339887498949;
+    constexpr int c_goldenIterations = 24;
+    const revolutions_per_minute_t c_windowTolerance = revolutions_per_minute_t(1.0);
+
+    double SmoothCost(const HeightPolicyFitOptions& options, double d0, double h0, double d1, double h1)
+    {
+        double slope = (h1 - h0) / (d1 - d0);
+        return options.cost.smoothWeight * slope * slope;
+    }
+}
+
+HeightAboveHubPolicy::HeightAboveHubPolicy(vector<meter_t> distances, vector<meter_t> heights)
+    : m_distances(move(distances))
+    , m_heights(move(heights))
+{
+    m_heights.resize(m_distances.size(), defaultHeightAboveHub);
+
+    vector<size_t> order(m_distances.size());
+    iota(order.begin(), order.end(), 0);
+    sort(order.begin(), order.end(), [this](size_t a, size_t b) { return m_distances[a] < m_distances[b]; });
+
+    vector<meter_t> d(order.size()), h(order.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        d[i] = m_distances[order[i]];
+        h[i] = m_heights[order[i]];
+    }
+    m_distances = move(d);
+    m_heights = move(h);
+}
+
+HeightAboveHubPolicy HeightAboveHubPolicy::Linear(meter_t nearDist, meter_t hahHigh, meter_t farDist, meter_t hahLow)
+{
+    return HeightAboveHubPolicy({ nearDist, farDist }, { hahHigh, hahLow });
+}
+
+meter_t HeightAboveHubPolicy::Evaluate(meter_t distance) const
+{
+    if (m_distances.empty())
+        return defaultHeightAboveHub;
+    if (distance <= m_distances.front())
+        return m_heights.front();
+    if (distance >= m_distances.back())
+        return m_heights.back();
+
+    auto hi = lower_bound(m_distances.begin(), m_distances.end(), distance);
+    size_t i = hi - m_distances.begin();
+    double t = ((distance - m_distances[i - 1]) / (m_distances[i] - m_distances[i - 1])).value();
+    return m_heights[i - 1] + t * (m_heights[i] - m_heights[i - 1]);
+}
+
+double HeightPolicyPointCost(const ShooterConfig& config, const HeightPolicyFitOptions& options, meter_t distance, meter_t heightAboveHub)
+{
+    ShotSolution s = SolveShot(config, distance, options.targetDist, heightAboveHub, options.targetHeight);
+    if (!isfinite(s.rpm.value()))
+        return c_infeasibleCost;
+
+    vector<RpmWindow> window;
+    SolveRpmWindowBatch(config, vector<meter_t>{ distance }, vector<degree_t>{ s.angleInit }, options.targetDist, options.targetHeight, window, c_windowTolerance);
+    double width = (window[0].maxRpm - window[0].minRpm).value();
+    if (!window[0].bValid || width <= 0.0)
+        return c_infeasibleCost;
+
+    const HeightPolicyCost& c = options.cost;
+    double landing = (90.0 - fabs(s.landingAngle.value())) / 90.0;
+    double rpm = (s.rpm / c.rpmScale).value();
+    double tolerance = c.toleranceScale.value() / width;
+    return c.landingWeight * landing * landing + c.rpmWeight * rpm * rpm + c.toleranceWeight * tolerance * tolerance;
+}
+
+HeightAboveHubPolicy FitHeightAboveHubPolicy(const ShooterConfig& config, const vector<meter_t>& distances, const HeightPolicyFitOptions& options)
+{
+    // Breakpoints need distinct distances, the smoothness term divides by their spacing
+    vector<meter_t> sorted;
+    sorted.reserve(distances.size());
+    for (meter_t distance : distances)
+    {
+        if (isfinite(distance.value()))
+            sorted.push_back(distance);
+    }
+    sort(sorted.begin(), sorted.end());
+    sorted.erase(unique(sorted.begin(), sorted.end()), sorted.end());
+    size_t count = sorted.size();
+    if (count == 0)
+        return HeightAboveHubPolicy();
+
+    const int k = std::max(options.candidates, 2);
+    const double hMin = options.minHeightAboveHub.value();
+    const double hMax = options.maxHeightAboveHub.value();
+    const double step = (hMax - hMin) / (k - 1);
+    vector<double> d(count);
+    for (size_t i = 0; i < count; i++)
+        d[i] = sorted[i].value();
+
+    // Point costs for every (breakpoint, candidate) pair, independent of each other
+    vector<double> pointCost(count * k);
+    ParallelFor(count * k, options.threads, [&](size_t begin, size_t end, unsigned)
+    {
+        for (size_t n = begin; n < end; n++)
+            pointCost[n] = HeightPolicyPointCost(config, options, sorted[n / k], meter_t(hMin + (n % k) * step));
+    });
+
+    // The smoothness term only couples neighbors, so the grid optimum is a shortest path along the chain
+    vector<double> total(pointCost.begin(), pointCost.begin() + k);
+    vector<int> from(count * k, 0);
+    for (size_t i = 1; i < count; i++)
+    {
+        vector<double> next(k);
+        for (int j = 0; j < k; j++)
+        {
+            double best = numeric_limits<double>::infinity();
+            for (int p = 0; p < k; p++)
+            {
+                double c = total[p] + SmoothCost(options, d[i - 1], hMin + p * step, d[i], hMin + j * step);
+                if (c < best)
+                {
+                    best = c;
+                    from[i * k + j] = p;
+                }
+            }
+            next[j] = best + pointCost[i * k + j];
+        }
+        total = move(next);
+    }
+
+    vector<double> h(count);
+    int j = static_cast<int>(min_element(total.begin(), total.end()) - total.begin());
+    for (size_t i = count; i-- > 0; )
+    {
+        h[i] = hMin + j * step;
+        j = from[i * k + j];
+    }
+
+    // Off grid polish, each breakpoint only sees its neighbors so even and odd halves can run in parallel
+    auto localCost = [&](size_t i, double hi)
+    {
+        double c = HeightPolicyPointCost(config, options, sorted[i], meter_t(hi));
+        if (i > 0)
+            c += SmoothCost(options, d[i - 1], h[i - 1], d[i], hi);
+        if (i + 1 < count)
+            c += SmoothCost(options, d[i], hi, d[i + 1], h[i + 1]);
+        return c;
+    };
+
+    for (int pass = 0; pass < options.refinePasses; pass++)
+    {
+        for (size_t parity = 0; parity < 2; parity++)
+        {
+            ParallelFor((count + 1 - parity) / 2, options.threads, [&](size_t begin, size_t end, unsigned)
+            {
+                for (size_t n = begin; n < end; n++)
+                {
+                    size_t i = 2 * n + parity;
+                    double a = std::max(h[i] - step, hMin);
+                    double b = std::min(h[i] + step, hMax);
+                    double x1 = b - c_goldenRatio * (b - a);
+                    double x2 = a + c_goldenRatio * (b - a);
+                    double f1 = localCost(i, x1);
+                    double f2 = localCost(i, x2);
+                    for (int it = 0; it < c_goldenIterations; it++)
+                    {
+                        if (f1 < f2)
+                        {
+                            b = x2;
+                            x2 = x1;
+                            f2 = f1;
+                            x1 = b - c_goldenRatio * (b - a);
+                            f1 = localCost(i, x1);
+                        }
+                        else
+                        {
+                            a = x1;
+                            x1 = x2;
+                            f1 = f2;
+                            x2 = a + c_goldenRatio * (b - a);
+                            f2 = localCost(i, x2);
+                        }
+                    }
+                    // Keep the grid point if the bracket interior is no better, the cost has infeasible steps
+                    double xBest = f1 < f2 ? x1 : x2;
+                    if (std::min(f1, f2) < localCost(i, h[i]))
+                        h[i] = xBest;
+                }
+            });
+        }
+    }
+
+    vector<meter_t> heights(count);
+    for (size_t i = 0; i < count; i++)
+        heights[i] = meter_t(h[i]);
+    return HeightAboveHubPolicy(sorted, heights);
+}
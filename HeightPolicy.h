@@ -0,0 +1,65 @@
+/// Fitted heightAboveHub(distance) policy
+///
+/// The #if 0 sweep in main.cpp interpolates heightAboveHub linearly from hahHigh at nearDist to
+/// hahLow at farDist. HeightAboveHubPolicy generalizes that to a piecewise linear curve through
+/// any number of breakpoints, and FitHeightAboveHubPolicy() places the breakpoint heights by
+/// minimizing a cost built from the landing angle, the flywheel RPM and the RPM tolerance window.
+
+#pragma once
+
+#include <vector>
+
+#include "ShotSolver.h"
+
+class HeightAboveHubPolicy
+{
+public:
+    HeightAboveHubPolicy() = default;
+    HeightAboveHubPolicy(std::vector<meter_t> distances, std::vector<meter_t> heights);
+
+    /// The hand tuned rule from main.cpp: hahHigh at nearDist falling linearly to hahLow at farDist
+    static HeightAboveHubPolicy Linear(meter_t nearDist, meter_t hahHigh, meter_t farDist, meter_t hahLow);
+
+    /// Piecewise linear between breakpoints, held constant past either end
+    meter_t Evaluate(meter_t distance) const;
+
+    bool IsEmpty() const { return m_distances.empty(); }
+    const std::vector<meter_t>& Distances() const { return m_distances; }
+    const std::vector<meter_t>& Heights() const { return m_heights; }
+
+private:
+    std::vector<meter_t> m_distances;   //!< Floor distance to the front rim, ascending
+    std::vector<meter_t> m_heights;
+};
+
+struct HeightPolicyCost
+{
+    double landingWeight = 1.0;         //!< Penalizes shallow landings, ((90 - |landing angle|) / 90)^2
+    double rpmWeight = 1.0;             //!< (rpm / rpmScale)^2
+    double toleranceWeight = 1.0;       //!< (toleranceScale / RPM window width)^2
+    double smoothWeight = 0.1;          //!< Squared slope of the policy between neighboring breakpoints [m/m]
+    revolutions_per_minute_t rpmScale = revolutions_per_minute_t(5000.0);
+    revolutions_per_minute_t toleranceScale = revolutions_per_minute_t(100.0);
+};
+
+struct HeightPolicyFitOptions
+{
+    HeightPolicyCost cost;
+    meter_t targetDist = defaultTargetDist;
+    meter_t targetHeight = defaultTargetHeight;
+    meter_t minHeightAboveHub = hubRimHeight + fuelRadius;
+    meter_t maxHeightAboveHub = hubRimHeight + foot_t(3.0);
+    int candidates = 32;                //!< Grid heights per breakpoint for the global pass
+    int refinePasses = 2;               //!< Red-black golden section passes after the grid pass
+    unsigned threads = 0;               //!< 0 uses std::thread::hardware_concurrency()
+};
+
+/// Cost of one breakpoint on its own, without the smoothness term
+double HeightPolicyPointCost(const ShooterConfig& config, const HeightPolicyFitOptions& options, meter_t distance, meter_t heightAboveHub);
+
+/// Fits the breakpoint heights at the given distances, which are sorted and duplicates dropped. The point costs on the candidate grid are
+/// evaluated for all breakpoints in parallel, the smoothness coupled chain is then solved exactly on
+/// that grid by dynamic programming and polished off grid with golden section searches.
+HeightAboveHubPolicy FitHeightAboveHubPolicy(const ShooterConfig& config
+                                           , const std::vector<meter_t>& distances
+                                           , const HeightPolicyFitOptions& options = HeightPolicyFitOptions());
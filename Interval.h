@@ -0,0 +1,116 @@
+/// Interval arithmetic scalar
+///
+/// An Interval is a guaranteed enclosure [lo, hi] of a real value. Every operation returns an
+/// interval containing all results for any values drawn from its operands, so code templated on
+/// its scalar type run once with Interval bounds its output over a whole box of inputs. Results are
+/// padded outward by a few ulps instead of switching the FPU rounding mode, which keeps it portable
+/// and also covers the rounding of the units library conversion factors and the libm functions.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/// Outward padding applied to every computed bound
+constexpr double c_intervalPadUlps = 4.0;
+
+inline double IntervalPadDown(double x)
+{
+    if (!std::isfinite(x))
+        return x;
+    return x - (std::fabs(x) * c_intervalPadUlps * std::numeric_limits<double>::epsilon() + std::numeric_limits<double>::denorm_min());
+}
+
+inline double IntervalPadUp(double x)
+{
+    if (!std::isfinite(x))
+        return x;
+    return x + (std::fabs(x) * c_intervalPadUlps * std::numeric_limits<double>::epsilon() + std::numeric_limits<double>::denorm_min());
+}
+
+struct Interval
+{
+    double lo = 0.0;
+    double hi = 0.0;
+
+    constexpr Interval() = default;
+    constexpr Interval(double v) : lo(v), hi(v) {}
+    constexpr Interval(double l, double h) : lo(l), hi(h) {}
+
+    /// Bounds computed in round to nearest, padded outward
+    static Interval Outward(double l, double h) { return Interval(IntervalPadDown(l), IntervalPadUp(h)); }
+    static Interval Entire() { return Interval(-std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()); }
+
+    double Mid() const { return 0.5 * (lo + hi); }
+    double Width() const { return hi - lo; }
+    bool Contains(double v) const { return lo <= v && v <= hi; }
+
+    friend Interval operator-(const Interval& a) { return Interval(-a.hi, -a.lo); }
+    friend Interval operator+(const Interval& a, const Interval& b) { return Outward(a.lo + b.lo, a.hi + b.hi); }
+    friend Interval operator-(const Interval& a, const Interval& b) { return Outward(a.lo - b.hi, a.hi - b.lo); }
+
+    friend Interval operator*(const Interval& a, const Interval& b)
+    {
+        // x * x of the same variable cannot go negative
+        if (&a == &b)
+            return Sqr(a);
+        double p[] = { a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi };
+        return Outward(*std::min_element(p, p + 4), *std::max_element(p, p + 4));
+    }
+
+    friend Interval operator/(const Interval& a, const Interval& b)
+    {
+        if (b.lo <= 0.0 && b.hi >= 0.0)
+            return Entire();
+        double q[] = { a.lo / b.lo, a.lo / b.hi, a.hi / b.lo, a.hi / b.hi };
+        return Outward(*std::min_element(q, q + 4), *std::max_element(q, q + 4));
+    }
+
+    friend Interval Sqr(const Interval& a)
+    {
+        double l = a.lo * a.lo;
+        double h = a.hi * a.hi;
+        if (a.lo <= 0.0 && a.hi >= 0.0)
+            return Interval(0.0, IntervalPadUp(std::max(l, h)));
+        return Outward(std::min(l, h), std::max(l, h));
+    }
+
+    // Comparisons look at the midpoint, templated code branches as the plain path would at the box center
+    friend bool operator<(const Interval& a, const Interval& b) { return a.Mid() < b.Mid(); }
+    friend bool operator>(const Interval& a, const Interval& b) { return a.Mid() > b.Mid(); }
+};
+
+/// Smallest interval containing both
+inline Interval Hull(const Interval& a, const Interval& b) { return Interval(std::min(a.lo, b.lo), std::max(a.hi, b.hi)); }
+
+/// Domain restricted to x >= 0, i.e. encloses the real square roots of the interval
+inline Interval sqrt(const Interval& a) { return Interval::Outward(std::sqrt(std::fmax(a.lo, 0.0)), std::sqrt(a.hi)); }
+inline Interval atan(const Interval& a) { return Interval::Outward(std::atan(a.lo), std::atan(a.hi)); }
+
+/// Monotone on each branch, the whole line if the interval spans a pole
+inline Interval tan(const Interval& a)
+{
+    const double pi = 3.141592653589793;
+    if (std::floor(a.lo / pi + 0.5) != std::floor(a.hi / pi + 0.5))
+        return Interval::Entire();
+    return Interval::Outward(std::tan(a.lo), std::tan(a.hi));
+}
+
+/// Endpoints plus any maximum (2k pi) or minimum ((2k+1) pi) inside the interval
+inline Interval cos(const Interval& a)
+{
+    const double pi = 3.141592653589793;
+    double l = std::min(std::cos(a.lo), std::cos(a.hi));
+    double h = std::max(std::cos(a.lo), std::cos(a.hi));
+    if (std::floor(a.hi / (2.0 * pi)) > std::floor(a.lo / (2.0 * pi)))
+        h = 1.0;
+    if (std::floor((a.hi - pi) / (2.0 * pi)) > std::floor((a.lo - pi) / (2.0 * pi)))
+        l = -1.0;
+    return Interval(std::max(IntervalPadDown(l), -1.0), std::min(IntervalPadUp(h), 1.0));
+}
+
+inline Interval sin(const Interval& a) { return cos(a - Interval(3.141592653589793 / 2.0)); }
+
+/// Midpoint, so templated code can branch on either double or Interval
+inline double ValueOf(const Interval& a) { return a.Mid(); }
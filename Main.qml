@@ -72,6 +72,7 @@ Window {
 	{
 		if (_ballistics && mainWindow.windowReady && flywheelMassSlider.value !== 128)
 		{
+			var traceBegin = _ballistics.traceNow();
 			_ballistics.setPhysicalProperties(flywheelMassSlider.value
 											, flywheelRadiusSlider.value
 											, minAngleSlider.value
@@ -82,9 +83,43 @@ Window {
 			var revs = _ballistics.calc(inputDist, inputTargetDist, inputHeightAbove, inputTargetHeight);
 			//print("distance ", inputDist, " targetDist ", inputTargetDist, " heightAboveHub ", inputHeightAbove, " targetHeight ", inputTargetHeight, " revs ", revs);
 			canvas.requestPaint();
+			_ballistics.traceStage("updateView", traceBegin);
 		}
 	}
 
+	// Ctrl+T writes the stage timings (BALLISTICS_TRACE builds) for Perfetto
+	Shortcut {
+		sequence: "Ctrl+T"
+		onActivated: _ballistics.dumpTrace("ballistics_trace.json")
+	}
+
+	// Solver counters overlay, bottom left
+	Timer {
+		interval: 1000
+		running: _ballistics !== null
+		repeat: true
+		onTriggered: _ballistics.refreshSolverStats()
+	}
+
+	Text {
+		anchors.left: parent.left
+		anchors.bottom: parent.bottom
+		anchors.margins: 8
+		z: 1
+		color: "white"
+		font.family: "Consolas"
+		font.pointSize: 9
+		visible: _ballistics !== null
+		text: _ballistics ? "solves " + _ballistics.statSolves.toFixed(0)
+							+ "  clamped " + (100 * _ballistics.statClampRate).toFixed(1) + "%"
+							+ "  infeasible " + (100 * _ballistics.statInfeasibleRate).toFixed(1) + "%"
+							+ "  region cache " + (100 * _ballistics.statCacheHitRate).toFixed(0) + "%"
+							+ "  p50 " + _ballistics.statLatencyP50.toFixed(2) + " us"
+							+ "  p99 " + _ballistics.statLatencyP99.toFixed(2) + " us"
+							+ "  max " + _ballistics.statLatencyMax.toFixed(1) + " us"
+						  : ""
+	}
+
 	Row {
 		spacing: 50
 
@@ -224,6 +259,30 @@ Window {
 				}
 			}
 
+			// Mass, radius and inertia fraction of a known flywheel, the sliders then scale it
+			Row {
+				spacing: 10
+
+				Label {
+					width: sliderLabelWidth
+					height: sliderHgt
+					verticalAlignment: Text.AlignVCenter
+					color: "white"
+					text: "flywheel"
+				}
+
+				ComboBox {
+					width: sliderWid - sliderLabelWidth - 10
+					model: [ "Solid cylinder", "SDS hollow" ]
+					onActivated: (index) => {
+						_ballistics.setFlywheelPreset(index);
+						flywheelMassSlider.value = _ballistics.flywheelMass;
+						flywheelRadiusSlider.value = _ballistics.flywheelRadius;
+						updateView();
+					}
+				}
+			}
+
 			Button {
 				text: "Recalculate"
 				onClicked: updateView()
@@ -253,6 +312,7 @@ Window {
 			Text { font: labelFont; text: "Physical Constraints" }
 			AlgInfoTextRow { lbl: "  flywheelMass"; valueMetric: _ballistics ? _ballistics.flywheelMass : 0; unitsMetric: "[kg]"; convImperial: poundPerkilogram ; unitsImerial:"[lb]"; decimalPlaces: 1 }
 			AlgInfoTextRow { lbl: "  flywheelRadius"; valueMetric: _ballistics ? _ballistics.flywheelRadius : 0; unitsMetric: "[m]"; convImperial: inchesPerMeter ; unitsImerial:"[in]"; decimalPlaces: 1 }
+			AlgInfoTextRow { lbl: "  flywheelInertiaFrac"; valueMetric: _ballistics ? _ballistics.flywheelInertiaFrac : 0; unitsMetric: "[M R^2]"; convImperial: 1.0 ; unitsImerial:"[M R^2]"; decimalPlaces: 3 }
 			AlgInfoTextRow { lbl: "  minAngle"; valueMetric: _ballistics ? _ballistics.minAngle : 0; unitsMetric: "[deg]"; convImperial: degPerRad ; unitsImerial:"[rad]"; decimalPlaces: 1 }
 			AlgInfoTextRow { lbl: "  maxAngle"; valueMetric: _ballistics ? _ballistics.maxAngle : 0; unitsMetric: "[deg]"; convImperial: degPerRad ; unitsImerial:"[rad]"; decimalPlaces: 1 }
 		}
@@ -272,6 +332,7 @@ Window {
 		property real pxPerMeterY: height / viewMetersHeight;
 
 		onPaint: {
+			var traceBegin = _ballistics ? _ballistics.traceNow() : 0;
 			var ctx = getContext("2d");
 			ctx.reset();
 			ctx.resetTransform();
@@ -294,6 +355,57 @@ Window {
 			yOffset = floorOffset;						// Reset to the floor
 			drawRobot(ctx, xOffset, yOffset);
 			drawHub(ctx, xOffset, yOffset);
+
+			ctx.resetTransform();						// The region inset is drawn in pixels
+			drawFeasibleRegion(ctx, width - 240, height - 230, 220, 160);
+
+			if (_ballistics)
+				_ballistics.traceStage("onPaint", traceBegin);
+		}
+
+		function drawFeasibleRegion(ctx, xInset, yInset, wInset, hInset) {
+			// Every (RPM, angle) pair that scores from this distance, with the current solution marked
+			var region = _ballistics.feasibleRegion(inputDist);
+			var rpmSpan = region.maxRpm - region.minRpm;
+			var angleSpan = region.maxAngle - region.minAngle;
+
+			ctx.fillStyle = Qt.rgba(1, 1, 1, 0.6);
+			ctx.fillRect(xInset, yInset, wInset, hInset);
+			ctx.strokeStyle = "black";
+			ctx.lineWidth = 1;
+			ctx.strokeRect(xInset, yInset, wInset, hInset);
+
+			// RPM increases right, angle increases up
+			function toX(rpm) { return xInset + (rpm - region.minRpm) / rpmSpan * wInset; }
+			function toY(angle) { return yInset + hInset - (angle - region.minAngle) / angleSpan * hInset; }
+
+			ctx.fillStyle = Qt.rgba(0, 0.6, 0, 0.4);
+			ctx.strokeStyle = "darkgreen";
+			for (var i = 0; i < region.polygons.length; i++) {
+				var outline = region.polygons[i];
+				ctx.beginPath();
+				for (var j = 0; j < outline.length; j++) {
+					if (j === 0) {
+						ctx.moveTo(toX(outline[j].x), toY(outline[j].y));
+					} else {
+						ctx.lineTo(toX(outline[j].x), toY(outline[j].y));
+					}
+				}
+				ctx.closePath();
+				ctx.fill();
+				ctx.stroke();
+			}
+
+			var markerSize = 4;
+			ctx.strokeStyle = "red";
+			ctx.beginPath();
+			ctx.ellipse(toX(_ballistics.outputRpms) - markerSize, toY(_ballistics.outputInitAngle) - markerSize, 2 * markerSize, 2 * markerSize);
+			ctx.stroke();
+
+			ctx.fillStyle = "black";
+			ctx.font = "10px sans-serif";
+			ctx.fillText("RPM " + region.minRpm.toFixed(0) + " - " + region.maxRpm.toFixed(0), xInset + 4, yInset + hInset - 4);
+			ctx.fillText("angle " + region.minAngle.toFixed(0) + " - " + region.maxAngle.toFixed(0) + " deg", xInset + 4, yInset + 12);
 		}
 
 		function drawParabola(ctx, xOffset, yOffset) {
@@ -0,0 +1,126 @@
+#include "MonteCarlo.h"
+#include "CounterRng.h"
+#include "Parallel.h"
+
+#include <cmath>
+
+using namespace std;
+
+namespace
+{
+    constexpr size_t c_blockSize = 256;     // Samples evaluated together as structure of arrays
+
+    struct Tally
+    {
+        uint64_t hits = 0;
+        uint64_t shorts = 0;
+        uint64_t frontRimClips = 0;
+        uint64_t longs = 0;
+        uint64_t entries = 0;
+        double sumOffset = 0.0;
+        double sumOffsetSq = 0.0;
+    };
+
+    double Draw(const Perturbation& p, double normal, uint32_t raw)
+    {
+        if (p.type == Perturbation::Uniform)
+            return p.bias + p.spread * (2.0 * CounterRng::ToUniform(raw) - 1.0);
+        return p.bias + p.spread * normal;
+    }
+
+    void EvaluateRange(const ShooterConfig& config, const MonteCarloOptions& options, uint64_t begin, uint64_t end, Tally& tally)
+    {
+        CounterRng rng(options.seed);
+
+        const double h0 = config.launchHeight.value();
+        const double coneDiameter = hubConeDiameter.value();
+        const double dist = options.distance.value();
+        const double radius = config.flywheelRadius.value();
+        const double flywheelMass = config.flywheelMass.value();
+        const double inertiaFrac = config.flywheelInertiaFrac.value();
+
+        double angle[c_blockSize];
+        double vel[c_blockSize];
+
+        for (uint64_t block = begin; block < end; block += c_blockSize)
+        {
+            size_t n = static_cast<size_t>(std::min<uint64_t>(c_blockSize, end - block));
+
+            // Draw the perturbations and look up the setpoint the robot would command
+            for (size_t i = 0; i < n; i++)
+            {
+                CounterRng::Block r0 = rng.Generate(block + i, 0);
+                CounterRng::Block r1 = rng.Generate(block + i, 1);
+                double n0, n1, n2, n3;
+                CounterRng::ToNormal(r0[0], r0[1], n0, n1);
+                CounterRng::ToNormal(r0[2], r0[3], n2, n3);
+
+                meter_t measured = options.distance + meter_t(Draw(options.visionDist, n0, r1[0]));
+                ShotSolution setpoint = SolveShot(config, measured, options.targetDist, options.heightAboveHub, options.targetHeight);
+
+                double rpm = setpoint.rpm.value() + Draw(options.flywheelRpm, n1, r1[1]);
+                double ballMass = DefaultShooterModel::GamePiece::mass.value() + Draw(options.fuelMass, n3, r1[3]);
+                angle[i] = radian_t(setpoint.angleInit).value() + degree_t(Draw(options.hoodAngle, n2, r1[2])).convert<radian>().value();
+                vel[i] = rpm * (2.0 * 3.141592653589793 / 60.0) * radius / DefaultShooterModel::SpeedFactor(flywheelMass / ballMass, inertiaFrac);
+            }
+
+            // Forward trajectory, branch free so it vectorizes
+            for (size_t i = 0; i < n; i++)
+            {
+                ShotOutcome o = EvaluateShotOutcome(h0, dist, angle[i], vel[i]);
+                double offset = o.entryDist - (dist + 0.5 * coneDiameter);
+
+                tally.hits += o.bHit;
+                tally.shorts += o.bShort;
+                tally.frontRimClips += o.bFrontRim;
+                tally.longs += o.bLong;
+                tally.entries += o.bReaches;
+                tally.sumOffset += o.bReaches ? offset : 0.0;
+                tally.sumOffsetSq += o.bReaches ? offset * offset : 0.0;
+            }
+        }
+    }
+}
+
+MonteCarloResult RunShotMonteCarlo(const ShooterConfig& config, const MonteCarloOptions& options)
+{
+    unsigned threads = options.threads == 0 ? DefaultThreadCount() : options.threads;
+    vector<Tally> tallies(threads);
+
+    ParallelFor(static_cast<size_t>(options.samples), threads, [&](size_t begin, size_t end, unsigned t)
+    {
+        EvaluateRange(config, options, begin, end, tallies[t]);
+    });
+
+    Tally total;
+    for (const Tally& t : tallies)
+    {
+        total.hits += t.hits;
+        total.shorts += t.shorts;
+        total.frontRimClips += t.frontRimClips;
+        total.longs += t.longs;
+        total.entries += t.entries;
+        total.sumOffset += t.sumOffset;
+        total.sumOffsetSq += t.sumOffsetSq;
+    }
+
+    MonteCarloResult result;
+    result.samples = options.samples;
+    result.hits = total.hits;
+    result.shorts = total.shorts;
+    result.frontRimClips = total.frontRimClips;
+    result.longs = total.longs;
+    if (options.samples > 0)
+    {
+        double p = static_cast<double>(total.hits) / options.samples;
+        result.hitProbability = p;
+        result.hitProbabilityStdErr = sqrt(p * (1.0 - p) / options.samples);
+    }
+    if (total.entries > 0)
+    {
+        result.meanEntryOffset = total.sumOffset / total.entries;
+        result.stdEntryOffset = sqrt(std::max(0.0, total.sumOffsetSq / total.entries - result.meanEntryOffset * result.meanEntryOffset));
+    }
+
+    return result;
+}
@@ -0,0 +1,56 @@
+/// Monte Carlo shot dispersion and hit probability
+///
+/// The robot measures the distance with vision, looks up the setpoint with SolveShot() and then
+/// the flywheel, hood and game piece deviate from nominal. Each sample pushes the perturbed shot
+/// through the drag-free forward trajectory and checks that it drops into the hub cone without
+/// clipping either rim.
+
+#pragma once
+
+#include <cstdint>
+
+#include "ShotSolver.h"
+
+/// Error distribution for one input, in that input's natural units
+struct Perturbation
+{
+    enum Type { Normal, Uniform };
+
+    Type type = Normal;
+    double bias = 0.0;      //!< Constant offset added to every sample
+    double spread = 0.0;    //!< Standard deviation for Normal, half width for Uniform
+};
+
+struct MonteCarloOptions
+{
+    meter_t distance = meter_t(3.0);                    //!< True floor distance to the front rim
+    meter_t targetDist = defaultTargetDist;
+    meter_t heightAboveHub = defaultHeightAboveHub;
+    meter_t targetHeight = defaultTargetHeight;
+
+    Perturbation visionDist{Perturbation::Normal, 0.0, 0.05};   //!< [m]
+    Perturbation flywheelRpm{Perturbation::Normal, 0.0, 50.0};  //!< [rpm]
+    Perturbation hoodAngle{Perturbation::Normal, 0.0, 0.5};     //!< [deg]
+    Perturbation fuelMass{Perturbation::Uniform, 0.0, 0.01};    //!< [kg]
+
+    uint64_t samples = 1000000;
+    uint64_t seed = 2026;
+    unsigned threads = 0;                               //!< 0 uses std::thread::hardware_concurrency()
+};
+
+struct MonteCarloResult
+{
+    uint64_t samples = 0;
+    uint64_t hits = 0;
+    uint64_t shorts = 0;            //!< Below the front rim or never reached rim height
+    uint64_t frontRimClips = 0;     //!< Fuel center within one radius of the front rim
+    uint64_t longs = 0;             //!< Dropped past the far side of the cone opening
+    double hitProbability = 0.0;
+    double hitProbabilityStdErr = 0.0;
+    double meanEntryOffset = 0.0;   //!< Mean of where the fuel crosses rim height relative to the cone center [m]
+    double stdEntryOffset = 0.0;
+};
+
+/// Runs the simulation. The counts are identical for any thread count since every sample draws its
+/// random numbers from a counter-based generator keyed by the sample index.
+MonteCarloResult RunShotMonteCarlo(const ShooterConfig& config, const MonteCarloOptions& options = MonteCarloOptions());
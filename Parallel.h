@@ -0,0 +1,41 @@
+/// Minimal thread fan-out used by the batch/sweep subsystems
+
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+/// Number of worker threads to use when the caller passes 0
+inline unsigned DefaultThreadCount()
+{
+    unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+/// Splits [0, count) into contiguous chunks and runs func(begin, end, threadIndex) on each chunk
+/// in its own thread. The calling thread runs the first chunk. Returns once all chunks are done.
+template <typename Func>
+void ParallelFor(size_t count, unsigned threads, Func func)
+{
+    if (threads == 0)
+        threads = DefaultThreadCount();
+    threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(count, 1)));
+
+    size_t chunk = (count + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (unsigned t = 1; t < threads; t++)
+    {
+        size_t begin = t * chunk;
+        size_t end = std::min(count, begin + chunk);
+        if (begin >= end)
+            break;
+        workers.emplace_back(func, begin, end, t);
+    }
+
+    func(size_t(0), std::min(count, chunk), 0u);
+
+    for (auto& w : workers)
+        w.join();
+}
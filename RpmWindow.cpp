@@ -0,0 +1,104 @@
+#include "RpmWindow.h"
+
+#include <cmath>
+
+using namespace std;
+
+namespace
+{
+    constexpr double c_rpmToRadPerSec = 2.0 * 3.141592653589793 / 60.0;
+    constexpr double c_bracketScale = 2.0;      // Outer brackets start at nominal / 2 and nominal * 2
+}
+
+void SolveRpmWindowBatch(const ShooterConfig& config
+                       , const vector<meter_t>& distances
+                       , const vector<degree_t>& hoodAngles
+                       , meter_t targetDist
+                       , meter_t targetHeight
+                       , vector<RpmWindow>& results
+                       , revolutions_per_minute_t tolerance)
+{
+    size_t count = distances.size();
+    results.resize(count);
+
+    const double h0 = config.launchHeight.value();
+    const double velPerRpm = c_rpmToRadPerSec * config.flywheelRadius.value() / config.SpeedFactor();
+
+    // Bracket state per lane, structure of arrays so each bisection pass is one tight loop
+    vector<double> dist(count), angle(count);
+    vector<double> lowLo(count), lowHi(count);      // Invariant: lowLo misses, lowHi scores
+    vector<double> highLo(count), highHi(count);    // Invariant: highLo scores, highHi misses
+    double maxWidth = 0.0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        RpmWindow& w = results[i];
+        FixedHoodSolution nominal = SolveFixedHood(config, hoodAngles[i], distances[i], targetDist, targetHeight);
+        w = RpmWindow();
+        w.distance = distances[i];
+        w.hoodAngle = hoodAngles[i];
+        w.nominalRpm = nominal.shot.rpm;
+
+        dist[i] = distances[i].value();
+        angle[i] = radian_t(hoodAngles[i]).value();
+        double rpm = nominal.shot.rpm.value();
+        w.bValid = nominal.bFeasible && EvaluateShotOutcome(h0, dist[i], angle[i], rpm * velPerRpm).bHit;
+        if (!w.bValid)
+            continue;
+
+        lowLo[i] = rpm / c_bracketScale;
+        lowHi[i] = rpm;
+        highLo[i] = rpm;
+        highHi[i] = rpm * c_bracketScale;
+
+        // Widen the outer brackets until they miss, scoring RPMs form one contiguous band
+        while (EvaluateShotOutcome(h0, dist[i], angle[i], lowLo[i] * velPerRpm).bHit)
+            lowLo[i] /= c_bracketScale;
+        while (EvaluateShotOutcome(h0, dist[i], angle[i], highHi[i] * velPerRpm).bHit)
+            highHi[i] *= c_bracketScale;
+
+        maxWidth = std::max(maxWidth, std::max(lowHi[i] - lowLo[i], highHi[i] - highLo[i]));
+    }
+
+    // Every lane runs the same number of halvings, enough for the widest bracket
+    int passes = maxWidth > 0.0 ? static_cast<int>(std::ceil(std::log2(maxWidth / tolerance.value()))) : 0;
+    for (int pass = 0; pass < passes; pass++)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            double midLow = 0.5 * (lowLo[i] + lowHi[i]);
+            bool bLowScores = EvaluateShotOutcome(h0, dist[i], angle[i], midLow * velPerRpm).bHit;
+            lowLo[i] = bLowScores ? lowLo[i] : midLow;
+            lowHi[i] = bLowScores ? midLow : lowHi[i];
+
+            double midHigh = 0.5 * (highLo[i] + highHi[i]);
+            bool bHighScores = EvaluateShotOutcome(h0, dist[i], angle[i], midHigh * velPerRpm).bHit;
+            highLo[i] = bHighScores ? midHigh : highLo[i];
+            highHi[i] = bHighScores ? highHi[i] : midHigh;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!results[i].bValid)
+            continue;
+        // Report the inner brackets, both are known to score
+        results[i].minRpm = revolutions_per_minute_t(lowHi[i]);
+        results[i].maxRpm = revolutions_per_minute_t(highLo[i]);
+    }
+}
+
+void SolveRpmWindowBatch(const ShooterConfig& config
+                       , const vector<meter_t>& distances
+                       , meter_t targetDist
+                       , meter_t heightAboveHub
+                       , meter_t targetHeight
+                       , vector<RpmWindow>& results
+                       , revolutions_per_minute_t tolerance)
+{
+    vector<degree_t> hoodAngles(distances.size());
+    for (size_t i = 0; i < distances.size(); i++)
+        hoodAngles[i] = SolveShot(config, distances[i], targetDist, heightAboveHub, targetHeight).angleInit;
+
+    SolveRpmWindowBatch(config, distances, hoodAngles, targetDist, targetHeight, results, tolerance);
+}
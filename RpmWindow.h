@@ -0,0 +1,41 @@
+/// RPM tolerance window per distance
+///
+/// For a distance and hood angle, finds the lowest and highest flywheel RPM whose drag free arc
+/// still clears the front rim and drops inside the cone opening. The band is what the flywheel
+/// "at speed" check should allow at that distance instead of one global tolerance.
+
+#pragma once
+
+#include <vector>
+
+#include "ShotSolver.h"
+
+struct RpmWindow
+{
+    meter_t distance = meter_t(0.0);
+    degree_t hoodAngle = degree_t(0.0);
+    revolutions_per_minute_t nominalRpm = revolutions_per_minute_t(0.0);    //!< Lands on the requested target point
+    revolutions_per_minute_t minRpm = revolutions_per_minute_t(0.0);
+    revolutions_per_minute_t maxRpm = revolutions_per_minute_t(0.0);
+    bool bValid = false;                    //!< False if even the nominal RPM does not score at this angle
+};
+
+/// Bracketed bisection for all distances in lock step; results[i] corresponds to distances[i]
+/// \param hoodAngles   One hood angle per distance
+/// \param tolerance    Width the RPM brackets are narrowed to
+void SolveRpmWindowBatch(const ShooterConfig& config
+                       , const std::vector<meter_t>& distances
+                       , const std::vector<degree_t>& hoodAngles
+                       , meter_t targetDist
+                       , meter_t targetHeight
+                       , std::vector<RpmWindow>& results
+                       , revolutions_per_minute_t tolerance = revolutions_per_minute_t(0.5));
+
+/// Same, using the hood angle SolveShot() picks for each distance
+void SolveRpmWindowBatch(const ShooterConfig& config
+                       , const std::vector<meter_t>& distances
+                       , meter_t targetDist
+                       , meter_t heightAboveHub
+                       , meter_t targetHeight
+                       , std::vector<RpmWindow>& results
+                       , revolutions_per_minute_t tolerance = revolutions_per_minute_t(0.5));
@@ -0,0 +1,128 @@
+/// Game piece and shooter geometry policies
+///
+/// ShooterModel<Piece, Geometry> bundles a game piece with a flywheel arrangement at compile time:
+/// every constant is a static constexpr of the policy types. The solvers take the model as a template
+/// parameter (SolveShotT<S, Model>, ShooterConfig::SpeedFactor<Model>() and the RPM <-> exit velocity
+/// conversions), so each combination gets its own solver with the constants folded in and no runtime
+/// switch on the hot path. DefaultShooterModel is what the app, Calculations and the stateless solvers
+/// run with; changing game piece or flywheel arrangement is changing that alias. One binary can still
+/// instantiate several models and compare them side by side, see CompareShooterModels() in ShotSolver.h.
+///
+/// A game piece policy provides name, mass, radius, inertiaFrac (over m r^2) and drag (DragCoefficients).
+/// A geometry policy provides name and a constexpr SpeedFactor(massRatio, flywheelInertiaFrac, pieceInertiaFrac)
+/// giving the flywheel surface speed over the ball exit velocity, see FlywheelSpeedFactor().
+
+#pragma once
+
+#include <ratio>
+#include <string>
+#include <vector>
+
+#include "BallisticsConstants.h"
+#include "Trajectory.h"
+
+/// 2026 fuel, the constants the app uses
+struct Fuel2026
+{
+    static constexpr const char* name = "Fuel 2026";
+    static constexpr kilogram_t mass = fuelMass;
+    static constexpr meter_t radius = fuelRadius;
+    static constexpr scalar_t inertiaFrac = fuelRotInertiaFrac;
+    static constexpr DragCoefficients drag = DragCoefficients{0.47, 0.0};
+};
+
+/// 2022 cargo, 9.5 in across and 9.5 oz, a thin walled rubber ball
+struct Cargo2022
+{
+    static constexpr const char* name = "Cargo 2022";
+    static constexpr kilogram_t mass = ounce_t(9.5);
+    static constexpr meter_t radius = inch_t(9.5 / 2.0);
+    static constexpr scalar_t inertiaFrac = 2.0 / 3.0;     // 2/3 Mr^2 hollow sphere
+    static constexpr DragCoefficients drag = DragCoefficients{0.47, 0.0};
+};
+
+/// One flywheel pushing the ball along a fixed hood, the formula in Calculations::CalcInitRPMs().
+/// The ball rolls on the hood, so it leaves at half the flywheel surface speed with topspin.
+struct SingleWheelHood
+{
+    static constexpr const char* name = "Single wheel and hood";
+
+    static constexpr double SpeedFactor(double massRatio, double flywheelInertiaFrac, double pieceInertiaFrac)
+    {
+        return 2.0 + (pieceInertiaFrac + 1.0) / (flywheelInertiaFrac * massRatio);
+    }
+};
+
+/// Two matched counter rotating flywheels either side of the ball, e.g. a vertical or horizontal pair.
+/// The ball leaves at the surface speed without spin. Flywheel mass and inertia are for both wheels together.
+struct DualWheel
+{
+    static constexpr const char* name = "Dual wheel";
+
+    static constexpr double SpeedFactor(double massRatio, double flywheelInertiaFrac, double /*pieceInertiaFrac*/)
+    {
+        return 1.0 + 1.0 / (flywheelInertiaFrac * massRatio);
+    }
+};
+
+/// Main flywheel under the ball with a top wheel geared to it at SurfaceRatio of its surface speed, which
+/// puts backspin on the ball. The ball leaves at the mean of the two surface speeds and spins at half
+/// their difference; the impulse that takes is split between the wheels through the gearing. Flywheel mass
+/// and inertia are the gear train's equivalent referred to the main wheel surface. SurfaceRatio = 1 is DualWheel.
+template <class SurfaceRatio = std::ratio<1, 2>>
+struct BackspinWheel
+{
+    static constexpr const char* name = "Backspin wheel";
+    static constexpr double c_surfaceRatio = static_cast<double>(SurfaceRatio::num) / SurfaceRatio::den;
+
+    static constexpr double SpeedFactor(double massRatio, double flywheelInertiaFrac, double pieceInertiaFrac)
+    {
+        constexpr double sum = 1.0 + c_surfaceRatio;
+        constexpr double diff = 1.0 - c_surfaceRatio;
+        return 2.0 / sum + (sum * sum + pieceInertiaFrac * diff * diff) / (2.0 * sum * flywheelInertiaFrac * massRatio);
+    }
+};
+
+template <class Piece, class Geometry>
+struct ShooterModel
+{
+    using GamePiece = Piece;
+    using Shooter = Geometry;
+
+    static std::string Name() { return std::string(Piece::name) + ", " + Geometry::name; }
+
+    /// Flywheel surface speed over ball exit velocity
+    static constexpr double SpeedFactor(double massRatio, double flywheelInertiaFrac)
+    {
+        return Geometry::SpeedFactor(massRatio, flywheelInertiaFrac, Piece::inertiaFrac.value());
+    }
+
+    static constexpr double SpeedFactor(kilogram_t flywheelMass, scalar_t flywheelInertiaFrac)
+    {
+        return SpeedFactor((flywheelMass / Piece::mass).value(), flywheelInertiaFrac.value());
+    }
+
+    static revolutions_per_minute_t ExitVelToRpm(meters_per_second_t vel, kilogram_t flywheelMass, meter_t flywheelRadius, scalar_t flywheelInertiaFrac)
+    {
+        return radians_per_second_t{vel.value() / flywheelRadius.value() * SpeedFactor(flywheelMass, flywheelInertiaFrac)};
+    }
+
+    static meters_per_second_t RpmToExitVel(revolutions_per_minute_t rpm, kilogram_t flywheelMass, meter_t flywheelRadius, scalar_t flywheelInertiaFrac)
+    {
+        radians_per_second_t rotVel = rpm;
+        return meters_per_second_t{rotVel.value() * flywheelRadius.value() / SpeedFactor(flywheelMass, flywheelInertiaFrac)};
+    }
+
+    /// Drag and lift constants for Trajectory.h, 1/2 rho C A / m of this game piece
+    static constexpr double c_aeroPerMass = 0.5 * airDensity.value() * 3.14159265358979 * Piece::radius.value() * Piece::radius.value() / Piece::mass.value();
+
+    static void SimulateTrajectories(const std::vector<LaunchConditions<double>>& launches, std::vector<TrajectoryResult<double>>& results)
+    {
+        SimulateTrajectoryBatch(launches, Piece::drag.cd, Piece::drag.cl, results, c_trajectoryTimeStep, c_aeroPerMass);
+    }
+};
+
+/// What the app runs with
+using DefaultShooterModel = ShooterModel<Fuel2026, SingleWheelHood>;
+
+static_assert(DefaultShooterModel::SpeedFactor(c_flywheelMass, flywheelRotInertiaFrac) == FlywheelSpeedFactor(c_massRatio.value()), "Default model matches FlywheelSpeedFactor()");
@@ -0,0 +1,394 @@
+#include "ShotBatch.h"
+#include "SolverStats.h"
+
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+using namespace std;
+
+namespace
+{
+    constexpr double c_pi = 3.14159265358979323846;
+    constexpr double c_rpmPerRadPerSec = 60.0 / (2.0 * c_pi);
+
+    /// Select without a branch, both sides are already computed
+    template <class T>
+    inline T Pick(bool b, T ifTrue, T ifFalse) { return b ? ifTrue : ifFalse; }
+
+    /// Same operation order as the units library conversions, so the clamp threshold sees the same angle
+    template <class T>
+    inline T ToDegrees(T rad) { return rad * T(180) / T(c_pi); }
+
+    template <class T>
+    inline T ToRadians(T deg) { return deg / T(180) * T(c_pi); }
+
+    template <class T>
+    inline T SafeSqrt(T v) { return sqrt(fmax(v, T(0))); }
+
+    /// Relative error amplification of p - q, infinite or NaN when they cancel completely
+    template <class T>
+    inline T Cancellation(T p, T q) { return (fabs(p) + fabs(q)) / fabs(p - q); }
+
+    /// Loop invariants of a batch, an unclamped config gets an infinite hood range so the clamp is a no-op
+    template <class T>
+    struct LaneConstants
+    {
+        T g;
+        T launchHeight;
+        T minDeg;
+        T maxDeg;
+        T rpmPerVel;
+
+        explicit LaneConstants(const ShooterConfig& config)
+        {
+            const bool bClamp = config.bClampAngle && config.minAngle < config.maxAngle;
+            g = static_cast<T>(gravity.value());
+            launchHeight = static_cast<T>(config.launchHeight.value());
+            minDeg = bClamp ? static_cast<T>(config.minAngle.value()) : -numeric_limits<T>::infinity();
+            maxDeg = bClamp ? static_cast<T>(config.maxAngle.value()) : numeric_limits<T>::infinity();
+            rpmPerVel = static_cast<T>(config.SpeedFactor() / config.flywheelRadius.value() * c_rpmPerRadPerSec);
+        }
+    };
+
+    template <class T>
+    struct LaneSolution
+    {
+        T rpm;
+        T angleInit;        // [deg]
+        T landingAngle;     // [deg]
+        T timeOfFlight;
+        T heightMax;
+        T velInit;
+        T condition;        // Sum of the cancellation factors, relative error is about this times epsilon. Float only.
+        bool bClampEdge;    // Launch angle so close to a hood limit that rounding could flip the clamp. Float only.
+        ShotStatus status;
+    };
+
+    /// One lane of SolveShotT() with guarded square roots and divisions, see the file comment in ShotBatch.h
+    template <class T>
+    inline LaneSolution<T> SolveLane(const LaneConstants<T>& k, T d, T targetDist, T heightAboveHub, T th)
+    {
+        const T zero = T(0);
+        const T one = T(1);
+        const T big = numeric_limits<T>::max();
+        const T td = Pick(targetDist == zero, T(0.001), targetDist);   // Same 1mm stand in as SolveShotT()
+
+        // Apex fit, see SolveShotT()
+        const T hTarg = th - k.launchHeight;
+        const T totalXDist = d + td;
+        const T hAbove = heightAboveHub - k.launchHeight;
+        const T x = td * d * totalXDist;
+        const T xSafe = Pick(x != zero, x, one);
+        const T a = (d * hTarg - totalXDist * hAbove) / xSafe;
+        const T b = (totalXDist * totalXDist * hAbove - d * d * hTarg) / xSafe;
+        const bool bDegenerate = !(x != zero) | !(fabs(a) <= big) | !(fabs(b) <= big);
+        const T aSafe = Pick(a < zero, a, -one);
+        const T hMax = (-(b * b) / (T(4) * aSafe)) + k.launchHeight;
+
+        // A parabola that does not open downward has its apex at or below the launch point
+        const T riseLaunch = hMax - k.launchHeight;
+        const T riseTarget = hMax - th;
+        const bool bApexLow = !(a < zero) | !(riseLaunch >= zero) | !(riseTarget >= zero);
+        const T tofApex = SafeSqrt(T(2) * riseLaunch / k.g) + SafeSqrt(T(2) * riseTarget / k.g);
+        const T velYApex = SafeSqrt(T(2) * k.g * riseLaunch);
+        const T velXApex = totalXDist / Pick(tofApex > zero, tofApex, one);
+
+        const T angleFit = ToDegrees(atan(velYApex / Pick(velXApex != zero, velXApex, one)));
+        const T angleLimited = fmin(fmax(angleFit, k.minDeg), k.maxDeg);
+        const bool bClamped = fabs(angleLimited - angleFit) > T(0.0001);     // Within the threshold keeps the fitted angle, like ClampLaunchAngle()
+        const T angleDeg = Pick(bClamped, angleLimited, angleFit);
+        const T angle = ToRadians(angleDeg);
+
+        const T cosAngle = cos(angle);
+        const T tanAngle = tan(angle);
+        const T tanRise = totalXDist * tanAngle;
+        const T rise = tanRise - hTarg;
+        const bool bUnreachable = !(rise > zero);
+        const T vel = SafeSqrt(k.g * totalXDist * totalXDist / (T(2) * Pick(bUnreachable, one, rise))) / cosAngle;
+
+        // A clamped shot follows the clamped arc
+        const T velX = Pick(bClamped, vel * cosAngle, velXApex);
+        const T velY = Pick(bClamped, vel * cosAngle * tanAngle, velYApex);     // No sin(), with cos() it becomes a sincos() call that does not vectorise
+        const T velXSafe = Pick(velX != zero, velX, one);
+        const T tof = Pick(bClamped, totalXDist / velXSafe, tofApex);
+        const T landing = ToDegrees(atan((velY - k.g * tof) / velXSafe));
+
+        ShotStatus status = bClamped ? c_shotClamped : c_shotOk;
+        status = bUnreachable ? c_shotUnreachableAngle : status;
+        status = bApexLow ? c_shotApexBelowTarget : status;
+        status = bDegenerate ? c_shotDegenerateFit : status;
+        const bool bSolved = !(bUnreachable | bApexLow | bDegenerate);
+
+        LaneSolution<T> r;
+        r.condition = zero;
+        r.bClampEdge = false;
+        // Only a float lane needs the error estimate, a double lane is already the fallback
+        if constexpr (is_same_v<T, float>)
+        {
+            // Every subtraction that can cancel, from the input heights through the apex fit to the launch line
+            r.condition = Cancellation(th, k.launchHeight) + Cancellation(heightAboveHub, k.launchHeight)
+                        + Cancellation(d, -td)
+                        + Cancellation(d * hTarg, totalXDist * hAbove) + Cancellation(totalXDist * totalXDist * hAbove, d * d * hTarg)
+                        + Cancellation(hMax, k.launchHeight) + Cancellation(hMax, th)
+                        + Cancellation(tanRise, hTarg);
+            const T angleError = fabs(angleFit) * r.condition * numeric_limits<T>::epsilon();
+            const T edge = T(0.0001) + angleError;
+            r.bClampEdge = (fabs(angleFit - k.minDeg) < edge) | (fabs(angleFit - k.maxDeg) < edge);
+        }
+        r.rpm = Pick(bSolved, vel * k.rpmPerVel, zero);
+        r.angleInit = Pick(bSolved, angleDeg, zero);
+        r.landingAngle = Pick(bSolved, landing, zero);
+        r.timeOfFlight = Pick(bSolved, tof, zero);
+        r.heightMax = Pick(bSolved, hMax, zero);
+        r.velInit = Pick(bSolved, vel, zero);
+        r.status = status;
+        return r;
+    }
+
+    /// Column pointers taken once, so the lane loops do not reload them through the vectors
+    struct ResultColumns
+    {
+        double* rpm;
+        double* angleInit;
+        double* landingAngle;
+        double* timeOfFlight;
+        double* heightMax;
+        double* velInit;
+        uint8_t* status;
+        uint32_t* lane;
+
+        explicit ResultColumns(ShotBatchResults& results)
+            : rpm(results.rpm.data())
+            , angleInit(results.angleInit.data())
+            , landingAngle(results.landingAngle.data())
+            , timeOfFlight(results.timeOfFlight.data())
+            , heightMax(results.heightMax.data())
+            , velInit(results.velInit.data())
+            , status(results.status.data())
+            , lane(results.lane.data())
+        {
+        }
+    };
+
+    template <class T>
+    inline void StoreLane(const ResultColumns& c, size_t i, const LaneSolution<T>& r)
+    {
+        c.rpm[i] = r.rpm;
+        c.angleInit[i] = r.angleInit;
+        c.landingAngle[i] = r.landingAngle;
+        c.timeOfFlight[i] = r.timeOfFlight;
+        c.heightMax[i] = r.heightMax;
+        c.velInit[i] = r.velInit;
+        c.status[i] = r.status;
+        c.lane[i] = static_cast<uint32_t>(i);
+    }
+
+    /// Lanes per block of the float pass, small enough for the block to stay in L1
+    constexpr size_t c_floatBlockLanes = 256;
+
+    /// Float columns of one block. Being local they cannot alias the batch columns or each other, so
+    /// the lane loop vectorises without a runtime overlap check per pair of columns.
+    struct FloatBlock
+    {
+        float distance[c_floatBlockLanes];
+        float targetDist[c_floatBlockLanes];
+        float heightAboveHub[c_floatBlockLanes];
+        float targetHeight[c_floatBlockLanes];
+        float rpm[c_floatBlockLanes];
+        float angleInit[c_floatBlockLanes];
+        float landingAngle[c_floatBlockLanes];
+        float timeOfFlight[c_floatBlockLanes];
+        float heightMax[c_floatBlockLanes];
+        float velInit[c_floatBlockLanes];
+        uint8_t status[c_floatBlockLanes];
+        uint8_t bRedo[c_floatBlockLanes];     // Error estimate over the tolerance, or too close to a hood limit
+    };
+
+    template <class Dst, class Src>
+    inline void CopyColumn(Dst* dst, const Src* src, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+            dst[i] = static_cast<Dst>(src[i]);
+    }
+
+    void CountBatchStats(const ShotBatchResults& results)
+    {
+        array<size_t, c_numShotStatus> counts = CountShotStatus(results);
+        CountSolverEvent(c_statSolves, results.Size());
+        CountSolverEvent(c_statClamped, counts[c_shotClamped]);
+        CountSolverEvent(c_statInfeasible, results.Size() - counts[c_shotOk] - counts[c_shotClamped]);
+    }
+}
+
+const char* ShotStatusName(ShotStatus status)
+{
+    switch (status)
+    {
+    case c_shotOk:                  return "ok";
+    case c_shotClamped:             return "clamped";
+    case c_shotApexBelowTarget:     return "apex below target";
+    case c_shotUnreachableAngle:    return "unreachable angle";
+    case c_shotDegenerateFit:       return "degenerate fit";
+    default:                        return "unknown";
+    }
+}
+
+void ShotBatchInputs::Reserve(size_t count)
+{
+    distance.reserve(count);
+    targetDist.reserve(count);
+    heightAboveHub.reserve(count);
+    targetHeight.reserve(count);
+}
+
+void ShotBatchInputs::Add(const ShotInputs& inputs)
+{
+    distance.push_back(inputs.distance.value());
+    targetDist.push_back(inputs.targetDist.value());
+    heightAboveHub.push_back(inputs.heightAboveHub.value());
+    targetHeight.push_back(inputs.targetHeight.value());
+}
+
+void ShotBatchResults::Resize(size_t count)
+{
+    rpm.resize(count);
+    angleInit.resize(count);
+    landingAngle.resize(count);
+    timeOfFlight.resize(count);
+    heightMax.resize(count);
+    velInit.resize(count);
+    status.resize(count);
+    lane.resize(count);
+}
+
+ShotSolution ShotBatchResults::Row(size_t i) const
+{
+    ShotSolution s;
+    s.rpm = revolutions_per_minute_t(rpm[i]);
+    s.angleInit = degree_t(angleInit[i]);
+    s.landingAngle = degree_t(landingAngle[i]);
+    s.timeOfFlight = second_t(timeOfFlight[i]);
+    s.heightMax = meter_t(heightMax[i]);
+    s.velInit = meters_per_second_t(velInit[i]);
+    s.velXInit = s.velInit * units::math::cos(s.angleInit);
+    s.velYInit = s.velInit * units::math::sin(s.angleInit);
+    s.bClamped = status[i] == c_shotClamped;
+    return s;
+}
+
+void SolveShotBatch(const ShooterConfig& config, const ShotBatchInputs& inputs, ShotBatchResults& results)
+{
+    const size_t count = inputs.Size();
+    results.Resize(count);
+
+    const LaneConstants<double> k(config);
+    const ResultColumns out(results);
+    for (size_t i = 0; i < count; i++)
+        StoreLane(out, i, SolveLane(k, inputs.distance[i], inputs.targetDist[i], inputs.heightAboveHub[i], inputs.targetHeight[i]));
+
+    CountBatchStats(results);
+}
+
+size_t SolveShotBatchFast(const ShooterConfig& config, const ShotBatchInputs& inputs, ShotBatchResults& results, double tolerance)
+{
+    const size_t count = inputs.Size();
+    results.Resize(count);
+
+    const LaneConstants<float> kf(config);
+    const LaneConstants<double> k(config);
+    const float conditionLimit = static_cast<float>(tolerance / numeric_limits<float>::epsilon());
+    const ResultColumns out(results);
+    size_t redoCount = 0;
+
+    FloatBlock b;
+    for (size_t first = 0; first < count; first += c_floatBlockLanes)
+    {
+        const size_t n = std::min(c_floatBlockLanes, count - first);
+        CopyColumn(b.distance, inputs.distance.data() + first, n);
+        CopyColumn(b.targetDist, inputs.targetDist.data() + first, n);
+        CopyColumn(b.heightAboveHub, inputs.heightAboveHub.data() + first, n);
+        CopyColumn(b.targetHeight, inputs.targetHeight.data() + first, n);
+
+        // Every lane of the block in float. The fallback decision goes to a flag column rather than a
+        // queue, so no iteration depends on an earlier one.
+        for (size_t i = 0; i < n; i++)
+        {
+            const LaneSolution<float> r = SolveLane(kf, b.distance[i], b.targetDist[i], b.heightAboveHub[i], b.targetHeight[i]);
+            b.rpm[i] = r.rpm;
+            b.angleInit[i] = r.angleInit;
+            b.landingAngle[i] = r.landingAngle;
+            b.timeOfFlight[i] = r.timeOfFlight;
+            b.heightMax[i] = r.heightMax;
+            b.velInit[i] = r.velInit;
+            b.status[i] = r.status;
+            b.bRedo[i] = !(r.condition <= conditionLimit) | r.bClampEdge;
+        }
+
+        CopyColumn(out.rpm + first, b.rpm, n);
+        CopyColumn(out.angleInit + first, b.angleInit, n);
+        CopyColumn(out.landingAngle + first, b.landingAngle, n);
+        CopyColumn(out.timeOfFlight + first, b.timeOfFlight, n);
+        CopyColumn(out.heightMax + first, b.heightMax, n);
+        CopyColumn(out.velInit + first, b.velInit, n);
+        CopyColumn(out.status + first, b.status, n);
+        for (size_t i = 0; i < n; i++)
+            out.lane[first + i] = static_cast<uint32_t>(first + i);
+
+        // The flagged lanes again in double, from the original inputs
+        for (size_t i = 0; i < n; i++)
+        {
+            if (!b.bRedo[i])
+                continue;
+            const size_t lane = first + i;
+            StoreLane(out, lane, SolveLane(k, inputs.distance[lane], inputs.targetDist[lane], inputs.heightAboveHub[lane], inputs.targetHeight[lane]));
+            redoCount++;
+        }
+    }
+
+    CountBatchStats(results);
+    return redoCount;
+}
+
+array<size_t, c_numShotStatus> CountShotStatus(const ShotBatchResults& results)
+{
+    array<size_t, c_numShotStatus> counts{};
+    for (uint8_t s : results.status)
+        counts[s < c_numShotStatus ? s : uint8_t(c_shotDegenerateFit)]++;
+    return counts;
+}
+
+size_t SelectShotLanes(const ShotBatchResults& results, uint32_t statusMask, vector<uint32_t>& indices)
+{
+    // Write every index and only advance past the ones that match, no branch on the status
+    const size_t count = results.Size();
+    indices.resize(count);
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        indices[kept] = static_cast<uint32_t>(i);
+        kept += (statusMask >> results.status[i]) & 1u;
+    }
+    indices.resize(kept);
+    return kept;
+}
+
+size_t CompactShotBatch(ShotBatchResults& results, uint32_t statusMask)
+{
+    const size_t count = results.Size();
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        results.rpm[kept] = results.rpm[i];
+        results.angleInit[kept] = results.angleInit[i];
+        results.landingAngle[kept] = results.landingAngle[i];
+        results.timeOfFlight[kept] = results.timeOfFlight[i];
+        results.heightMax[kept] = results.heightMax[i];
+        results.velInit[kept] = results.velInit[i];
+        results.status[kept] = results.status[i];
+        results.lane[kept] = results.lane[i];
+        kept += (statusMask >> results.status[i]) & 1u;
+    }
+    results.Resize(kept);
+    return kept;
+}
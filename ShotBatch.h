@@ -0,0 +1,95 @@
+/// Batch shot solver with per lane validity codes
+///
+/// SolveShot() lets bad geometry fall through as NaN from units::math::sqrt and patches a zero
+/// target offset to 1mm. The batch form runs the same equations over structure-of-arrays columns and
+/// classifies every lane with a ShotStatus instead. The status comes from comparison masks and every
+/// square root and division takes a guarded argument, so the loop has no data dependent branches and
+/// invalid lanes cost the same as good ones; their outputs are zeroed so a sum or min over a column
+/// stays finite. Filter by status with SelectShotLanes() or CompactShotBatch().
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ShotSolver.h"
+
+/// Why a lane did or did not produce a shot. When several apply the lane gets the highest code.
+enum ShotStatus : uint8_t
+{
+    c_shotOk,
+    c_shotClamped,              //!< Solved, but the launch angle was clamped to the hood limits
+    c_shotApexBelowTarget,      //!< The fit through the rim point opens upward or peaks below the launch point or target
+    c_shotUnreachableAngle,     //!< The launch line at the (clamped) angle passes below the target
+    c_shotDegenerateFit,        //!< Zero distance or non-finite inputs, the apex fit has no solution
+    c_numShotStatus
+};
+
+constexpr uint32_t ShotStatusBit(ShotStatus status) { return 1u << status; }
+
+constexpr uint32_t c_shotSolvedMask = ShotStatusBit(c_shotOk) | ShotStatusBit(c_shotClamped);
+constexpr uint32_t c_shotFailedMask = ShotStatusBit(c_shotApexBelowTarget) | ShotStatusBit(c_shotUnreachableAngle) | ShotStatusBit(c_shotDegenerateFit);
+
+const char* ShotStatusName(ShotStatus status);
+
+/// Input columns in SI units, row i is one ShotInputs [m]
+struct ShotBatchInputs
+{
+    std::vector<double> distance;
+    std::vector<double> targetDist;
+    std::vector<double> heightAboveHub;
+    std::vector<double> targetHeight;
+
+    size_t Size() const { return distance.size(); }
+    void Reserve(size_t count);
+    void Add(const ShotInputs& inputs);
+};
+
+/// Output columns, row i belongs to input row lane[i]. Rows that are not solved hold zeros.
+struct ShotBatchResults
+{
+    std::vector<double> rpm;
+    std::vector<double> angleInit;          //!< [deg]
+    std::vector<double> landingAngle;       //!< [deg]
+    std::vector<double> timeOfFlight;       //!< [s]
+    std::vector<double> heightMax;          //!< [m]
+    std::vector<double> velInit;            //!< [m/s]
+    std::vector<uint8_t> status;            //!< ShotStatus
+    std::vector<uint32_t> lane;             //!< Input row, i until the results are compacted
+
+    size_t Size() const { return status.size(); }
+    void Resize(size_t count);
+    /// Row i as a ShotSolution, velXInit and velYInit are rebuilt from the exit velocity and angle
+    ShotSolution Row(size_t i) const;
+};
+
+/// Solves every input row, results are resized to match
+void SolveShotBatch(const ShooterConfig& config, const ShotBatchInputs& inputs, ShotBatchResults& results);
+
+/// Default relative error allowed on a float lane of SolveShotBatchFast()
+constexpr double c_fastPathTolerance = 1e-5;
+
+/// Float fast path. Each lane also sums the cancellation factors (|p| + |q|) / |p - q| of every
+/// subtraction on the way to the apex and the launch line, which times the float epsilon estimates its
+/// relative error. Near the degenerate cases (the 1mm target offset, a rim point almost on the line to
+/// the target, an apex just at launch height) the factors blow up, and those lanes are recomputed in
+/// double, as are lanes whose launch angle is too close to a hood limit to trust the clamp decision.
+/// The float pass runs over blocks of local columns with no branch and no dependency between lanes,
+/// so it vectorises wherever the compiler has vector trig functions (MSVC, or glibc with fast math).
+/// \param tolerance    Relative error allowed before a lane falls back to double
+/// \return Lanes recomputed in double
+size_t SolveShotBatchFast(const ShooterConfig& config, const ShotBatchInputs& inputs, ShotBatchResults& results, double tolerance = c_fastPathTolerance);
+
+/// Rows per ShotStatus
+std::array<size_t, c_numShotStatus> CountShotStatus(const ShotBatchResults& results);
+
+/// Row indices whose status bit is set in statusMask, in order
+/// \return Number of indices written
+size_t SelectShotLanes(const ShotBatchResults& results, uint32_t statusMask, std::vector<uint32_t>& indices);
+
+/// Keeps only the rows whose status bit is set in statusMask, in order, and shrinks every column to
+/// match. The lane column still names each row's input.
+/// \return Rows kept
+size_t CompactShotBatch(ShotBatchResults& results, uint32_t statusMask);
@@ -0,0 +1,277 @@
+#include "ShotSolver.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace units::math;
+
+ShotSolution SolveShot(const ShooterConfig& config
+                     , meter_t distance
+                     , meter_t targetDist
+                     , meter_t heightAboveHub
+                     , meter_t targetHeight)
+{
+    return SolveShotT<double>(config, distance, targetDist, heightAboveHub, targetHeight);
+}
+
+ShotSensitivities SolveShotSensitivities(const ShooterConfig& config, const ShotInputs& inputs)
+{
+    using D = UnitDual<meter_t, c_numShotInputs>;
+    ShotSolutionT<Dual<c_numShotInputs>> d = SolveShotT<Dual<c_numShotInputs>>(config
+        , D::Variable(inputs.distance, c_inputDistance)
+        , D::Variable(inputs.targetDist, c_inputTargetDist)
+        , D::Variable(inputs.heightAboveHub, c_inputHeightAboveHub)
+        , D::Variable(inputs.targetHeight, c_inputTargetHeight));
+
+    ShotSensitivities r;
+    r.shot.rpm = d.rpm.val;
+    r.shot.angleInit = d.angleInit.val;
+    r.shot.landingAngle = d.landingAngle.val;
+    r.shot.timeOfFlight = d.timeOfFlight.val;
+    r.shot.heightMax = d.heightMax.val;
+    r.shot.velInit = d.velInit.val;
+    r.shot.velXInit = d.velXInit.val;
+    r.shot.velYInit = d.velYInit.val;
+    r.shot.bClamped = d.bClamped;
+
+    for (int i = 0; i < c_numShotInputs; i++)
+    {
+        r.dRpm[i] = d.rpm.d[i].value();
+        r.dAngleInit[i] = d.angleInit.d[i].value();
+        r.dLandingAngle[i] = d.landingAngle.d[i].value();
+        r.dTimeOfFlight[i] = d.timeOfFlight.d[i].value();
+    }
+
+    return r;
+}
+
+void SolveShotSensitivitiesBatch(const ShooterConfig& config
+                               , const std::vector<ShotInputs>& inputs
+                               , std::vector<ShotSensitivities>& results)
+{
+    results.resize(inputs.size());
+    for (size_t i = 0; i < inputs.size(); i++)
+        results[i] = SolveShotSensitivities(config, inputs[i]);
+}
+
+ShotEnclosure SolveShotEnclosure(const ShooterConfig& config, const ShotInputBox& box, int splits, unsigned threads)
+{
+    using Span = UnitInterval<meter_t>;
+    const std::array<Span, 5> inputs = { box.launchHeight, box.distance, box.targetDist, box.heightAboveHub, box.targetHeight };
+
+    std::array<size_t, 5> pieces;
+    size_t count = 1;
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        pieces[i] = inputs[i].Width() > meter_t(0.0) ? static_cast<size_t>(std::max(splits, 1)) : 1;
+        count *= pieces[i];
+    }
+
+    // Sub-box n picks piece (n / stride) % pieces on each axis, the hull of the pieces is the box
+    auto subBox = [&](size_t n)
+    {
+        std::array<Span, 5> sub;
+        for (size_t i = 0; i < inputs.size(); i++)
+        {
+            size_t k = n % pieces[i];
+            n /= pieces[i];
+            meter_t step = inputs[i].Width() / static_cast<double>(pieces[i]);
+            meter_t lo = inputs[i].lo + static_cast<double>(k) * step;
+            sub[i] = Span(lo, k + 1 == pieces[i] ? inputs[i].hi : lo + step);
+        }
+        return SolveShotT<Interval>(config, sub[0], sub[1], sub[2], sub[3], sub[4]);
+    };
+
+    auto hull = [](ShotEnclosure& a, const ShotEnclosure& b)
+    {
+        a.rpm = Hull(a.rpm, b.rpm);
+        a.angleInit = Hull(a.angleInit, b.angleInit);
+        a.landingAngle = Hull(a.landingAngle, b.landingAngle);
+        a.timeOfFlight = Hull(a.timeOfFlight, b.timeOfFlight);
+        a.heightMax = Hull(a.heightMax, b.heightMax);
+        a.velInit = Hull(a.velInit, b.velInit);
+        a.velXInit = Hull(a.velXInit, b.velXInit);
+        a.velYInit = Hull(a.velYInit, b.velYInit);
+        a.bClamped = a.bClamped || b.bClamped;
+    };
+
+    if (threads == 0)
+        threads = DefaultThreadCount();
+    std::vector<ShotEnclosure> partial(threads);
+    std::vector<char> bUsed(threads, 0);  // Not vector<bool>, threads write neighboring flags
+    ParallelFor(count, threads, [&](size_t begin, size_t end, unsigned t)
+    {
+        partial[t] = subBox(begin);
+        for (size_t n = begin + 1; n < end; n++)
+            hull(partial[t], subBox(n));
+        bUsed[t] = 1;
+    });
+
+    ShotEnclosure e = partial[0];
+    for (unsigned t = 1; t < threads; t++)
+    {
+        if (bUsed[t])
+            hull(e, partial[t]);
+    }
+    return e;
+}
+
+MovingShotSolution SolveMovingShot(const ShooterConfig& config
+                                 , meter_t hubX
+                                 , meter_t hubY
+                                 , meters_per_second_t robotVelX
+                                 , meters_per_second_t robotVelY
+                                 , radian_t robotHeading
+                                 , meter_t targetDist
+                                 , meter_t heightAboveHub
+                                 , meter_t targetHeight
+                                 , second_t tolerance
+                                 , int maxIterations)
+{
+    MovingShotSolution m;
+    meter_t hubRadius = hubConeDiameter / 2.0;
+    second_t tof = second_t(0.0);
+    meter_t virtualX = hubX;
+    meter_t virtualY = hubY;
+
+    for (m.iterations = 1; m.iterations <= maxIterations; m.iterations++)
+    {
+        // The fuel keeps the robot velocity for the whole flight, so lead the hub by the opposite displacement
+        virtualX = hubX - robotVelX * tof;
+        virtualY = hubY - robotVelY * tof;
+        m.virtualDist = math::hypot(virtualX, virtualY);
+
+        m.shot = SolveShot(config, m.virtualDist - hubRadius, targetDist, heightAboveHub, targetHeight);
+
+        second_t delta = m.shot.timeOfFlight - tof;
+        tof = m.shot.timeOfFlight;
+        if (math::abs(delta) < tolerance)
+        {
+            m.bConverged = true;
+            break;
+        }
+    }
+    m.iterations = std::min(m.iterations, maxIterations);
+
+    radian_t yaw = math::atan2(virtualY, virtualX) - robotHeading;
+    // Wrap into [-180, 180)
+    m.turretYaw = math::atan2(math::sin(yaw), math::cos(yaw));
+
+    return m;
+}
+
+namespace
+{
+    /// Fills in everything that follows from a launch angle and exit velocity on a drag free arc
+    FixedHoodSolution CompleteArc(const ShooterConfig& config
+                                , radian_t angle
+                                , meters_per_second_t velInit
+                                , meter_t distance
+                                , meter_t totalXDist)
+    {
+        FixedHoodSolution f;
+        ShotSolution& s = f.shot;
+
+        s.angleInit = angle;
+        s.velInit = velInit;
+        s.velXInit = velInit * math::cos(angle);
+        s.velYInit = velInit * math::sin(angle);
+        s.timeOfFlight = totalXDist / s.velXInit;
+        s.heightMax = s.velYInit * s.velYInit / (2.0 * gravity) + config.launchHeight;
+        s.landingAngle = math::atan((s.velYInit - gravity * s.timeOfFlight) / s.velXInit);
+        s.rpm = config.ExitVelToRpm(velInit);
+
+        second_t tRim = distance / s.velXInit;
+        f.heightAtRim = config.launchHeight + s.velYInit * tRim - 0.5 * gravity * tRim * tRim;
+
+        // The fuel has to be coming down when it reaches the target to drop into the cone
+        f.bFeasible = std::isfinite(s.velInit.value()) && s.landingAngle < degree_t(0.0);
+
+        return f;
+    }
+}
+
+FixedHoodSolution SolveFixedHood(const ShooterConfig& config
+                               , degree_t hoodAngle
+                               , meter_t distance
+                               , meter_t targetDist
+                               , meter_t targetHeight)
+{
+    meter_t totalXDist = distance + targetDist;
+    meter_t totalYDist = targetHeight - config.launchHeight;
+
+    // Same as CalcInitVelWithAngle(), no real solution when the launch line passes below the target
+    meter_t rise = totalXDist * math::tan(hoodAngle) - totalYDist;
+    if (rise <= meter_t(0.0))
+    {
+        FixedHoodSolution f;
+        f.shot.angleInit = hoodAngle;
+        return f;
+    }
+
+    meters_per_second_t velInit = math::sqrt(gravity * totalXDist * totalXDist / (2.0 * rise)) / math::cos(hoodAngle);
+    return CompleteArc(config, hoodAngle, velInit, distance, totalXDist);
+}
+
+FixedRpmSolution SolveFixedRpm(const ShooterConfig& config
+                             , revolutions_per_minute_t rpm
+                             , meter_t distance
+                             , meter_t targetDist
+                             , meter_t targetHeight)
+{
+    FixedRpmSolution r;
+
+    meters_per_second_t v = config.RpmToExitVel(rpm);
+    double x = (distance + targetDist).value();
+    double y = (targetHeight - config.launchHeight).value();
+    double g = gravity.value();
+    double v2 = v.value() * v.value();
+
+    // tan(theta) = (v^2 +- sqrt(v^4 - g (g x^2 + 2 y v^2))) / (g x)
+    double disc = v2 * v2 - g * (g * x * x + 2.0 * y * v2);
+    if (disc < 0.0 || x <= 0.0)
+        return r;
+
+    double root = std::sqrt(disc);
+    radian_t high{std::atan((v2 + root) / (g * x))};
+    radian_t low{std::atan((v2 - root) / (g * x))};
+
+    r.highArc = CompleteArc(config, high, v, distance, meter_t(x));
+    r.lowArc = CompleteArc(config, low, v, distance, meter_t(x));
+
+    // Arcs outside the hood travel are not achievable on this robot
+    auto inHoodRange = [&config](const FixedHoodSolution& f)
+    {
+        return !config.bClampAngle || (f.shot.angleInit >= config.minAngle && f.shot.angleInit <= config.maxAngle);
+    };
+    r.highArc.bFeasible = r.highArc.bFeasible && inHoodRange(r.highArc);
+    r.lowArc.bFeasible = r.lowArc.bFeasible && inHoodRange(r.lowArc);
+    r.bReachable = true;
+
+    return r;
+}
+
+void SolveFixedHoodBatch(const ShooterConfig& config
+                       , degree_t hoodAngle
+                       , const std::vector<meter_t>& distances
+                       , meter_t targetDist
+                       , meter_t targetHeight
+                       , std::vector<FixedHoodSolution>& results)
+{
+    results.resize(distances.size());
+    for (size_t i = 0; i < distances.size(); i++)
+        results[i] = SolveFixedHood(config, hoodAngle, distances[i], targetDist, targetHeight);
+}
+
+void SolveFixedRpmBatch(const ShooterConfig& config
+                      , revolutions_per_minute_t rpm
+                      , const std::vector<meter_t>& distances
+                      , meter_t targetDist
+                      , meter_t targetHeight
+                      , std::vector<FixedRpmSolution>& results)
+{
+    results.resize(distances.size());
+    for (size_t i = 0; i < distances.size(); i++)
+        results[i] = SolveFixedRpm(config, rpm, distances[i], targetDist, targetHeight);
+}
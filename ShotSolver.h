@@ -0,0 +1,375 @@
+/// Stateless shot solver
+///
+/// Same equations as Calculations::CalcInitRPMs() but without member state or signal emission,
+/// so it can be called from the control loop, worker threads and iterative solvers.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "BallisticsConstants.h"
+#include "FlywheelInertia.h"
+#include "ShooterModels.h"
+#include "UnitDual.h"
+#include "UnitInterval.h"
+
+/// Bump whenever a change to the solvers alters their results, so cached sweeps (SweepCache.h)
+/// computed with the old equations are not reused
+constexpr uint32_t c_shotSolverVersion = 1;
+
+/// Physical properties of the shooter, mirrors Calculations::setPhysicalProperties()
+struct ShooterConfig
+{
+    kilogram_t flywheelMass = c_flywheelMass;
+    meter_t flywheelRadius = c_flywheelRadius;
+    degree_t minAngle = c_minAngle;
+    degree_t maxAngle = c_maxAngle;
+    meter_t launchHeight = robotHeight;
+    bool bClampAngle = true;
+    scalar_t flywheelInertiaFrac = flywheelRotInertiaFrac;     //!< Flywheel inertia over M R^2
+
+    /// Takes the mass, radius and inertia fraction from the flywheel's parts
+    constexpr void SetFlywheel(const FlywheelGeometry& flywheel)
+    {
+        flywheelMass = flywheel.Mass();
+        flywheelRadius = flywheel.Radius();
+        flywheelInertiaFrac = flywheel.InertiaFraction();
+    }
+
+    /// Flywheel surface speed over ball exit velocity for the game piece and arrangement of the model
+    template <class Model = DefaultShooterModel>
+    double SpeedFactor() const { return Model::SpeedFactor(flywheelMass, flywheelInertiaFrac); }
+
+    template <class Model = DefaultShooterModel>
+    revolutions_per_minute_t ExitVelToRpm(meters_per_second_t vel) const { return Model::ExitVelToRpm(vel, flywheelMass, flywheelRadius, flywheelInertiaFrac); }
+
+    template <class Model = DefaultShooterModel>
+    meters_per_second_t RpmToExitVel(revolutions_per_minute_t rpm) const { return Model::RpmToExitVel(rpm, flywheelMass, flywheelRadius, flywheelInertiaFrac); }
+
+    kilogram_square_meter_t FlywheelInertia() const { return flywheelInertiaFrac * flywheelMass * flywheelRadius * flywheelRadius; }
+};
+
+/// Solver outputs. S = double gives plain unit_t members, S = Dual<N> carries partial
+/// derivatives wrt the seeded inputs (see UnitDual.h)
+template <class S = double>
+struct ShotSolutionT
+{
+    Quantity<S, revolutions_per_minute_t> rpm = revolutions_per_minute_t(0.0);
+    Quantity<S, degree_t> angleInit = degree_t(0.0);
+    Quantity<S, degree_t> landingAngle = degree_t(0.0);
+    Quantity<S, second_t> timeOfFlight = second_t(0.0);
+    Quantity<S, meter_t> heightMax = meter_t(0.0);
+    Quantity<S, meters_per_second_t> velInit = meters_per_second_t(0.0);
+    Quantity<S, meters_per_second_t> velXInit = meters_per_second_t(0.0);
+    Quantity<S, meters_per_second_t> velYInit = meters_per_second_t(0.0);
+    bool bClamped = false;
+};
+
+using ShotSolution = ShotSolutionT<double>;
+
+/// Where a drag free shot ends up relative to the hub cone opening
+struct ShotOutcome
+{
+    double entryDist = 0.0;     //!< Floor distance where the fuel center descends through rim height [m]
+    bool bReaches = false;      //!< The arc gets up to rim height at all
+    bool bShort = false;        //!< Below the front rim or never reached rim height
+    bool bFrontRim = false;     //!< Fuel center within one radius of the front rim
+    bool bLong = false;         //!< Dropped past the far side of the cone opening
+    bool bHit = false;
+    double frontMargin = 0.0;   //!< Clearance of the fuel over the front rim, negative when it clips [m]
+    double backMargin = 0.0;    //!< Room left before the far side of the opening, negative when long [m]
+};
+
+/// Forward drag free trajectory y(x) = h0 + x tan(a) - g x^2 / (2 v^2 cos^2(a)) checked against the
+/// cone opening. Plain doubles in SI units and no branches so batch loops over it vectorize.
+/// \param launchHeight   [m]
+/// \param distance       Floor distance from the launch point to the front rim [m]
+/// \param angle          Launch angle [rad]
+/// \param vel            Exit velocity [m/s]
+/// \param ballRadius     [m]
+inline ShotOutcome EvaluateShotOutcome(double launchHeight, double distance, double angle, double vel, double ballRadius = DefaultShooterModel::GamePiece::radius.value())
+{
+    const double rimHeight = meter_t(hubRimHeight).value();
+    const double coneDiameter = hubConeDiameter.value();
+
+    double t = std::tan(angle);
+    double c = std::cos(angle);
+    double k = gravity.value() / (2.0 * vel * vel * c * c);
+
+    double yRim = launchHeight + distance * t - k * distance * distance;
+    double disc = t * t - 4.0 * k * (rimHeight - launchHeight);
+
+    ShotOutcome o;
+    o.entryDist = (t + std::sqrt(std::fmax(disc, 0.0))) / (2.0 * k);
+    o.bReaches = disc >= 0.0;
+    o.bShort = !o.bReaches || yRim < rimHeight - ballRadius;
+    o.bFrontRim = !o.bShort && yRim < rimHeight + ballRadius;
+    o.bLong = !o.bShort && !o.bFrontRim && o.entryDist > distance + coneDiameter - ballRadius;
+    o.bHit = !o.bShort && !o.bFrontRim && !o.bLong;
+    o.frontMargin = yRim - (rimHeight + ballRadius);
+    o.backMargin = distance + coneDiameter - ballRadius - o.entryDist;
+    return o;
+}
+
+/// Calculates the flywheel RPM and launch angle for a stationary shot
+/// \param distance         Floor distance to the front rim of the hub cone
+/// \param targetDist       Offset distance from the front rim to place the shot
+/// \param heightAboveHub   Height the shot passes over the front rim
+/// \param targetHeight     Height at the end point within the cone
+ShotSolution SolveShot(const ShooterConfig& config
+                     , meter_t distance
+                     , meter_t targetDist
+                     , meter_t heightAboveHub = defaultHeightAboveHub
+                     , meter_t targetHeight = defaultTargetHeight);
+
+/// Clamps the launch angle to the hood range, returns true if it was clamped. A clamped angle is a
+/// constant, so dual derivatives drop to zero. UnitInterval.h overloads this for enclosures.
+template <class Q>
+inline bool ClampLaunchAngle(Q& angle, degree_t minAngle, degree_t maxAngle)
+{
+    double clamped = std::clamp(ValueOf(angle), minAngle.value(), maxAngle.value());
+    if (std::fabs(clamped - ValueOf(angle)) > 0.0001)
+    {
+        angle = degree_t{clamped};
+        return true;
+    }
+    return false;
+}
+
+/// Generic form of SolveShot() templated on the scalar kind, see ShotSolutionT, and on the game piece
+/// and flywheel arrangement the RPM is for, see ShooterModels.h. The arc itself is drag free and does
+/// not depend on the model.
+/// \param launchHeight     Overrides config.launchHeight, so it can carry derivatives or bounds too
+template <class S, class Model = DefaultShooterModel>
+ShotSolutionT<S> SolveShotT(const ShooterConfig& config
+                          , Quantity<S, meter_t> launchHeight
+                          , Quantity<S, meter_t> distance
+                          , Quantity<S, meter_t> targetDist
+                          , Quantity<S, meter_t> heightAboveHub
+                          , Quantity<S, meter_t> targetHeight)
+{
+    using Meter = Quantity<S, meter_t>;
+    ShotSolutionT<S> s;
+
+    if (ValueOf(targetDist) == 0.0)
+    {
+        targetDist = Meter(meter_t(0.001));     // Dividing by this, use 1mm to avoid INF and/or NAN
+    }
+
+    // Fit the parabola through the launch point, over the rim and into the target to get the apex
+    Meter hTarg = targetHeight - launchHeight;
+    Meter totalXDist = distance + targetDist;
+    Meter hAbove = heightAboveHub - launchHeight;
+    auto x = targetDist * distance * totalXDist;
+    auto aValue = (distance * hTarg - totalXDist * hAbove) / x;
+    auto bValue = (totalXDist * totalXDist * hAbove - distance * distance * hTarg) / x;
+    s.heightMax = (-(bValue * bValue) / (4.0 * aValue)) + launchHeight;
+
+    s.timeOfFlight = units::math::sqrt(2.0 * (s.heightMax - launchHeight) / gravity)
+                   + units::math::sqrt(2.0 * (s.heightMax - targetHeight) / gravity);
+    s.velYInit = units::math::sqrt(2.0 * gravity * (s.heightMax - launchHeight));
+    s.velXInit = totalXDist / s.timeOfFlight;
+
+    s.angleInit = units::math::atan(s.velYInit / s.velXInit);
+    if (config.bClampAngle && config.minAngle < config.maxAngle)
+    {
+        s.bClamped = ClampLaunchAngle(s.angleInit, config.minAngle, config.maxAngle);
+    }
+
+    s.velInit = units::math::sqrt(gravity * totalXDist * totalXDist / (2.0 * (totalXDist * units::math::tan(s.angleInit) - hTarg)))
+              / units::math::cos(s.angleInit);
+
+    if (s.bClamped)
+    {
+        s.velYInit = s.velInit * units::math::sin(s.angleInit);
+        s.velXInit = s.velInit * units::math::cos(s.angleInit);
+        // Unlike Calculations::CalcInitVel() the flight time follows the clamped arc, the moving shot solver depends on it
+        s.timeOfFlight = totalXDist / s.velXInit;
+    }
+
+    s.landingAngle = units::math::atan((s.velYInit - gravity * s.timeOfFlight) / s.velXInit);
+
+    s.rpm = radian_t(1.0) * s.velInit / config.flywheelRadius * config.SpeedFactor<Model>();
+
+    return s;
+}
+
+template <class S, class Model = DefaultShooterModel>
+ShotSolutionT<S> SolveShotT(const ShooterConfig& config
+                          , Quantity<S, meter_t> distance
+                          , Quantity<S, meter_t> targetDist
+                          , Quantity<S, meter_t> heightAboveHub
+                          , Quantity<S, meter_t> targetHeight)
+{
+    return SolveShotT<S, Model>(config, Quantity<S, meter_t>(config.launchHeight), distance, targetDist, heightAboveHub, targetHeight);
+}
+
+/// Inputs to a stationary shot, see SolveShot()
+struct ShotInputs
+{
+    meter_t distance = meter_t(0.0);
+    meter_t targetDist = defaultTargetDist;
+    meter_t heightAboveHub = defaultHeightAboveHub;
+    meter_t targetHeight = defaultTargetHeight;
+};
+
+/// Column index of each input in the ShotSensitivities Jacobian rows
+enum ShotInputIndex
+{
+    c_inputDistance,
+    c_inputTargetDist,
+    c_inputHeightAboveHub,
+    c_inputTargetHeight,
+    c_numShotInputs
+};
+
+/// Solution plus its Jacobian wrt ShotInputs, all inputs are lengths so each entry is per meter
+struct ShotSensitivities
+{
+    ShotSolution shot;
+    std::array<double, c_numShotInputs> dRpm{};             //!< [rpm/m]
+    std::array<double, c_numShotInputs> dAngleInit{};       //!< [deg/m]
+    std::array<double, c_numShotInputs> dLandingAngle{};    //!< [deg/m]
+    std::array<double, c_numShotInputs> dTimeOfFlight{};    //!< [s/m]
+};
+
+/// One forward-mode AD pass of the solver, exact derivatives including across the angle clamp
+ShotSensitivities SolveShotSensitivities(const ShooterConfig& config, const ShotInputs& inputs);
+
+/// Batch variant, results[i] corresponds to inputs[i]
+void SolveShotSensitivitiesBatch(const ShooterConfig& config
+                               , const std::vector<ShotInputs>& inputs
+                               , std::vector<ShotSensitivities>& results);
+
+/// Input box for SolveShotEnclosure(), each input is a closed interval [m]
+struct ShotInputBox
+{
+    UnitInterval<meter_t> distance = UnitInterval<meter_t>(meter_t(0.0));
+    UnitInterval<meter_t> targetDist = UnitInterval<meter_t>(meter_t(defaultTargetDist));
+    UnitInterval<meter_t> heightAboveHub = UnitInterval<meter_t>(meter_t(defaultHeightAboveHub));
+    UnitInterval<meter_t> targetHeight = UnitInterval<meter_t>(meter_t(defaultTargetHeight));
+    UnitInterval<meter_t> launchHeight = UnitInterval<meter_t>(meter_t(robotHeight));
+};
+
+/// Guaranteed bounds on every solver output over the input box, bClamped means part of the box clamps
+using ShotEnclosure = ShotSolutionT<Interval>;
+
+/// Runs the solver once in interval arithmetic. A single pass overestimates because the apex fit uses
+/// each input more than once; splits > 1 cuts every input with nonzero width into that many pieces and
+/// returns the hull of the sub-box enclosures, tightening the bounds at splits^k solves for k uncertain inputs.
+ShotEnclosure SolveShotEnclosure(const ShooterConfig& config, const ShotInputBox& box, int splits = 1, unsigned threads = 1);
+
+struct MovingShotSolution
+{
+    ShotSolution shot;                      //!< Solution for the virtual target, in the robot frame
+    degree_t turretYaw = degree_t(0.0);     //!< Turret angle relative to the robot heading
+    meter_t virtualDist = meter_t(0.0);     //!< Vision distance to the virtual (lead compensated) hub center
+    int iterations = 0;
+    bool bConverged = false;
+};
+
+/// Shoot on the move: the fuel inherits the robot velocity, so aim at a virtual hub offset by
+/// -robotVel * timeOfFlight and iterate on the time of flight until it stops changing.
+/// \param hubX, hubY       Field frame vector from the launch point to the hub center (vision distance)
+/// \param robotVelX/Y      Field frame robot velocity
+/// \param robotHeading     Field frame robot heading, used to express the turret yaw in the robot frame
+MovingShotSolution SolveMovingShot(const ShooterConfig& config
+                                 , meter_t hubX
+                                 , meter_t hubY
+                                 , meters_per_second_t robotVelX
+                                 , meters_per_second_t robotVelY
+                                 , radian_t robotHeading = radian_t(0.0)
+                                 , meter_t targetDist = defaultTargetDist
+                                 , meter_t heightAboveHub = defaultHeightAboveHub
+                                 , meter_t targetHeight = defaultTargetHeight
+                                 , second_t tolerance = second_t(1e-4)
+                                 , int maxIterations = 20);
+
+/// Fixed hood: the launch angle is set, solve only for RPM (closed form, no apex fit)
+/// bFeasible is false when the angle is too shallow to reach the target height at all
+struct FixedHoodSolution
+{
+    ShotSolution shot;
+    meter_t heightAtRim = meter_t(0.0);     //!< Height the shot crosses the front rim at, check against the rim for clearance
+    bool bFeasible = false;
+};
+
+FixedHoodSolution SolveFixedHood(const ShooterConfig& config
+                               , degree_t hoodAngle
+                               , meter_t distance
+                               , meter_t targetDist = defaultTargetDist
+                               , meter_t targetHeight = defaultTargetHeight);
+
+/// Fixed flywheel speed: the exit velocity is set, solve for the hood angle. There are two arcs
+/// through the target whenever it is reachable.
+struct FixedRpmSolution
+{
+    FixedHoodSolution highArc;
+    FixedHoodSolution lowArc;
+    bool bReachable = false;                //!< False when the exit velocity cannot reach the target at any angle
+};
+
+FixedRpmSolution SolveFixedRpm(const ShooterConfig& config
+                             , revolutions_per_minute_t rpm
+                             , meter_t distance
+                             , meter_t targetDist = defaultTargetDist
+                             , meter_t targetHeight = defaultTargetHeight);
+
+/// Batch variants for table generation, results[i] corresponds to distances[i]
+void SolveFixedHoodBatch(const ShooterConfig& config
+                       , degree_t hoodAngle
+                       , const std::vector<meter_t>& distances
+                       , meter_t targetDist
+                       , meter_t targetHeight
+                       , std::vector<FixedHoodSolution>& results);
+
+void SolveFixedRpmBatch(const ShooterConfig& config
+                      , revolutions_per_minute_t rpm
+                      , const std::vector<meter_t>& distances
+                      , meter_t targetDist
+                      , meter_t targetHeight
+                      , std::vector<FixedRpmSolution>& results);
+
+struct ShooterModelComparison
+{
+    std::string model;
+    meter_t distance = meter_t(0.0);
+    ShotSolution shot;
+    ShotOutcome outcome;        //!< Drag free check of the solved shot with the model's game piece
+};
+
+/// Solves every distance with every model, rows are ordered by model, then distance
+template <class... Models>
+std::vector<ShooterModelComparison> CompareShooterModels(const ShooterConfig& config
+                                                       , const std::vector<meter_t>& distances
+                                                       , meter_t targetDist = defaultTargetDist
+                                                       , meter_t heightAboveHub = defaultHeightAboveHub
+                                                       , meter_t targetHeight = defaultTargetHeight)
+{
+    std::vector<ShooterModelComparison> rows;
+    rows.reserve(sizeof...(Models) * distances.size());
+
+    auto solveAll = [&](auto model)
+    {
+        using Model = decltype(model);
+        const std::string name = Model::Name();
+        for (meter_t d : distances)
+        {
+            ShooterModelComparison row;
+            row.model = name;
+            row.distance = d;
+            row.shot = SolveShotT<double, Model>(config, d, targetDist, heightAboveHub, targetHeight);
+            row.outcome = EvaluateShotOutcome(config.launchHeight.value(), d.value(), radian_t(row.shot.angleInit).value(), row.shot.velInit.value()
+                                            , Model::GamePiece::radius.value());
+            rows.push_back(row);
+        }
+    };
+    (solveAll(Models{}), ...);
+
+    return rows;
+}
@@ -0,0 +1,224 @@
+#include "SolverStats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+    /// One thread's counters, written only by that thread
+    struct StatsBlock
+    {
+        array<atomic<uint64_t>, c_numSolverCounters> counters{};
+        array<atomic<uint64_t>, c_latencyBuckets> latency{};
+    };
+
+    struct StatsRegistry
+    {
+        mutex lock;                     // Guards everything here, never taken on the record path
+        vector<StatsBlock*> blocks;     // Live threads
+        SolverStatsSnapshot retired;    // Counts of threads that have exited
+        SolverStatsSnapshot baseline;
+    };
+
+    StatsRegistry& Registry()
+    {
+        static StatsRegistry registry;
+        return registry;
+    }
+
+    /// Owns the calling thread's block and folds it into the retired counts when the thread exits
+    struct ThreadBlockOwner
+    {
+        unique_ptr<StatsBlock> block;
+
+        ~ThreadBlockOwner()
+        {
+            if (!block)
+                return;
+            StatsRegistry& r = Registry();
+            lock_guard<mutex> guard(r.lock);
+            for (size_t i = 0; i < c_numSolverCounters; i++)
+                r.retired.counters[i] += block->counters[i].load(memory_order_relaxed);
+            for (size_t i = 0; i < c_latencyBuckets; i++)
+                r.retired.latency[i] += block->latency[i].load(memory_order_relaxed);
+            r.blocks.erase(find(r.blocks.begin(), r.blocks.end(), block.get()));
+        }
+    };
+
+    StatsBlock& ThreadBlock()
+    {
+        thread_local ThreadBlockOwner owner;
+        if (!owner.block)
+        {
+            owner.block = make_unique<StatsBlock>();
+            StatsRegistry& r = Registry();
+            lock_guard<mutex> guard(r.lock);
+            r.blocks.push_back(owner.block.get());
+        }
+        return *owner.block;
+    }
+
+    /// Single writer increment, no locked read-modify-write needed
+    inline void Bump(atomic<uint64_t>& a, uint64_t n)
+    {
+        a.store(a.load(memory_order_relaxed) + n, memory_order_relaxed);
+    }
+
+    int HighestBit(uint64_t v)
+    {
+        int bit = 0;
+        for (int step = 32; step > 0; step /= 2)
+        {
+            if (v >> step)
+            {
+                v >>= step;
+                bit += step;
+            }
+        }
+        return bit;
+    }
+
+    SolverStatsSnapshot SumBlocks(StatsRegistry& r)
+    {
+        SolverStatsSnapshot s = r.retired;
+        for (const StatsBlock* b : r.blocks)
+        {
+            for (size_t i = 0; i < c_numSolverCounters; i++)
+                s.counters[i] += b->counters[i].load(memory_order_relaxed);
+            for (size_t i = 0; i < c_latencyBuckets; i++)
+                s.latency[i] += b->latency[i].load(memory_order_relaxed);
+        }
+        return s;
+    }
+
+    double Ratio(uint64_t num, uint64_t den)
+    {
+        return den > 0 ? static_cast<double>(num) / den : 0.0;
+    }
+}
+
+size_t LatencyBucket(int64_t ns)
+{
+    uint64_t v = ns > 0 ? static_cast<uint64_t>(ns) : 0;
+    if (v < c_latencySubBuckets)
+        return static_cast<size_t>(v);
+
+    int e = HighestBit(v);
+    if (e > static_cast<int>(c_latencyMaxExponent))
+        return c_latencyBuckets - 1;
+    size_t sub = static_cast<size_t>(v >> (e - 5)) & (c_latencySubBuckets - 1);
+    return (e - 4) * c_latencySubBuckets + sub;
+}
+
+int64_t LatencyBucketFloor(size_t bucket)
+{
+    if (bucket < c_latencySubBuckets)
+        return static_cast<int64_t>(bucket);
+    size_t e = bucket / c_latencySubBuckets + 4;
+    size_t sub = bucket % c_latencySubBuckets;
+    return static_cast<int64_t>((c_latencySubBuckets + sub) << (e - 5));
+}
+
+void CountSolverEvent(SolverCounter counter, uint64_t count)
+{
+    Bump(ThreadBlock().counters[counter], count);
+}
+
+void RecordSolveLatency(int64_t ns)
+{
+    Bump(ThreadBlock().latency[LatencyBucket(ns)], 1);
+}
+
+double SolverStatsSnapshot::ClampRate() const
+{
+    return Ratio(counters[c_statClamped], counters[c_statSolves]);
+}
+
+double SolverStatsSnapshot::InfeasibleRate() const
+{
+    return Ratio(counters[c_statInfeasible], counters[c_statSolves]);
+}
+
+double SolverStatsSnapshot::CacheHitRate() const
+{
+    return Ratio(counters[c_statCacheHits], counters[c_statCacheHits] + counters[c_statCacheMisses]);
+}
+
+double SolverStatsSnapshot::LatencyPercentileNs(double p) const
+{
+    if (latencySamples == 0)
+        return 0.0;
+
+    // Rank of the sample at p, then the bucket holding it
+    uint64_t rank = static_cast<uint64_t>(p * (latencySamples - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < c_latencyBuckets; i++)
+    {
+        seen += latency[i];
+        if (seen >= rank)
+            return 0.5 * (LatencyBucketFloor(i) + LatencyBucketFloor(i + 1));
+    }
+    return static_cast<double>(LatencyBucketFloor(c_latencyBuckets));
+}
+
+double SolverStatsSnapshot::LatencyMeanNs() const
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < c_latencyBuckets; i++)
+        sum += latency[i] * 0.5 * (LatencyBucketFloor(i) + LatencyBucketFloor(i + 1));
+    return latencySamples > 0 ? sum / latencySamples : 0.0;
+}
+
+double SolverStatsSnapshot::LatencyMaxNs() const
+{
+    for (size_t i = c_latencyBuckets; i > 0; i--)
+    {
+        if (latency[i - 1] > 0)
+            return static_cast<double>(LatencyBucketFloor(i));
+    }
+    return 0.0;
+}
+
+SolverStatsSnapshot TakeSolverStats()
+{
+    StatsRegistry& r = Registry();
+    lock_guard<mutex> guard(r.lock);
+    SolverStatsSnapshot s = SumBlocks(r);
+    for (size_t i = 0; i < c_numSolverCounters; i++)
+        s.counters[i] -= r.baseline.counters[i];
+    for (size_t i = 0; i < c_latencyBuckets; i++)
+    {
+        s.latency[i] -= r.baseline.latency[i];
+        s.latencySamples += s.latency[i];
+    }
+    return s;
+}
+
+void ResetSolverStats()
+{
+    StatsRegistry& r = Registry();
+    lock_guard<mutex> guard(r.lock);
+    r.baseline = SumBlocks(r);
+}
+
+void WriteSolverStats(ostream& out, const SolverStatsSnapshot& stats)
+{
+    out << "solves " << stats.Count(c_statSolves) << '\n'
+        << "clamped " << stats.Count(c_statClamped) << " (" << 100.0 * stats.ClampRate() << "%)\n"
+        << "infeasible " << stats.Count(c_statInfeasible) << " (" << 100.0 * stats.InfeasibleRate() << "%)\n"
+        << "region cache hits " << stats.Count(c_statCacheHits) << " misses " << stats.Count(c_statCacheMisses)
+        << " (" << 100.0 * stats.CacheHitRate() << "% hit)\n"
+        << "latency samples " << stats.latencySamples << '\n';
+    if (stats.latencySamples > 0)
+    {
+        out << "latency mean " << stats.LatencyMeanNs() << " ns\n";
+        for (double p : { 0.5, 0.9, 0.99, 0.999 })
+            out << "latency p" << 100.0 * p << ' ' << stats.LatencyPercentileNs(p) << " ns\n";
+        out << "latency max <= " << stats.LatencyMaxNs() << " ns\n";
+    }
+}
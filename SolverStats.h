@@ -0,0 +1,70 @@
+/// Solver counters and latency histograms
+///
+/// Always on, unlike the stage timers in StageTrace.h: the public entry points, Calculations::CalcInitRPMs()
+/// and the batch solver (ShotBatch.h), count every solve, every launch angle clamp and every infeasible
+/// (NaN) result, the region cache counts hits and misses, and CalcInitRPMs() records its latency. The
+/// SolveShot() primitive that the Monte Carlo, aim, height policy and design searches loop over is not
+/// counted, so the rates describe the shots the app actually asks for. Each thread owns a block of
+/// counters and histogram buckets that only it writes, so recording is a plain load and store with no
+/// lock or read-modify-write. TakeSolverStats() sums the live blocks, and a thread's counts are folded
+/// into a retired total when it exits, so short lived worker threads do not pile up blocks.
+///
+/// The latency histogram is log-linear like HdrHistogram: exact below 32 ns, then 32 buckets per
+/// power of two, so every percentile is within about 3% of the true value.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+enum SolverCounter
+{
+    c_statSolves,               //!< Calculations::CalcInitRPMs() calls and batch solver lanes
+    c_statClamped,              //!< Launch angle clamped to the hood limits
+    c_statInfeasible,           //!< Exit velocity came out NaN or infinite, the target is not reachable at the angle
+    c_statCacheHits,            //!< FeasibleRegionCache lookups served from the cache
+    c_statCacheMisses,          //!< FeasibleRegionCache lookups that traced a new region
+    c_numSolverCounters
+};
+
+constexpr size_t c_latencySubBuckets = 32;      // Per power of 2, also the exact linear range [ns]
+constexpr size_t c_latencyMaxExponent = 40;     // Values past 2^41 ns (~37 min) land in the last bucket
+constexpr size_t c_latencyBuckets = c_latencySubBuckets * (c_latencyMaxExponent - 3);
+
+/// Histogram bucket for a latency [ns]
+size_t LatencyBucket(int64_t ns);
+
+/// Smallest latency in a bucket [ns]
+int64_t LatencyBucketFloor(size_t bucket);
+
+void CountSolverEvent(SolverCounter counter, uint64_t count = 1);
+void RecordSolveLatency(int64_t ns);
+
+/// Sum over all threads at the time of the call
+struct SolverStatsSnapshot
+{
+    std::array<uint64_t, c_numSolverCounters> counters{};
+    std::array<uint64_t, c_latencyBuckets> latency{};
+    uint64_t latencySamples = 0;
+
+    uint64_t Count(SolverCounter c) const { return counters[c]; }
+    double ClampRate() const;               //!< Clamped over solves
+    double InfeasibleRate() const;          //!< Infeasible over solves
+    double CacheHitRate() const;            //!< Hits over lookups
+    /// \param p    Fraction in [0, 1], 0.5 for the median
+    /// \return Latency at that percentile [ns], the middle of its bucket
+    double LatencyPercentileNs(double p) const;
+    double LatencyMeanNs() const;
+    /// Top of the highest bucket with a sample in it [ns]
+    double LatencyMaxNs() const;
+};
+
+SolverStatsSnapshot TakeSolverStats();
+
+/// Later snapshots count from here. Threads keep writing their own blocks, so this only moves a baseline.
+void ResetSolverStats();
+
+/// Human readable dump, one counter or percentile per line
+void WriteSolverStats(std::ostream& out, const SolverStatsSnapshot& stats);
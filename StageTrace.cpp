@@ -0,0 +1,191 @@
+#include "StageTrace.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+    static_assert((c_traceRingCapacity & (c_traceRingCapacity - 1)) == 0, "Ring capacity must be a power of 2");
+
+    struct TraceEvent
+    {
+        const char* name;
+        int64_t beginNs;
+        int64_t endNs;
+    };
+
+    /// Single writer ring, only the owning thread advances head
+    struct TraceRing
+    {
+        array<TraceEvent, c_traceRingCapacity> events;
+        atomic<uint64_t> head{0};
+        atomic<uint64_t> tail{0};       // Events before this were cleared
+        uint32_t threadId = 0;
+    };
+
+    struct RetiredEvent
+    {
+        TraceEvent event;
+        uint32_t threadId;
+    };
+
+    struct TraceRegistry
+    {
+        mutex lock;                     // Guards everything here, never taken on the record path
+        vector<shared_ptr<TraceRing>> rings;    // Live threads
+        vector<RetiredEvent> retired;   // Events of threads that have exited, the newest c_traceRingCapacity
+        uint64_t retiredHead = 0;
+        uint64_t retiredTail = 0;       // Retired events before this were cleared
+        uint32_t nextThreadId = 1;
+        unordered_set<string> names;
+    };
+
+    TraceRegistry& Registry()
+    {
+        static TraceRegistry registry;
+        return registry;
+    }
+
+    void WriteJsonString(ostream& out, const char* s)
+    {
+        out << '"';
+        for (; *s; s++)
+        {
+            if (*s == '"' || *s == '\\')
+                out << '\\' << *s;
+            else if (static_cast<unsigned char>(*s) >= 0x20)
+                out << *s;
+        }
+        out << '"';
+    }
+
+    /// First event of a ring still worth exporting, given its head
+    uint64_t FirstLiveEvent(const TraceRing& ring, uint64_t head)
+    {
+        return max(ring.tail.load(memory_order_relaxed), head > c_traceRingCapacity ? head - c_traceRingCapacity : 0);
+    }
+
+    /// Owns the calling thread's ring. When the thread exits its events move into the shared retired
+    /// buffer, which is bounded like a ring, so threads that come and go do not each leave a ring behind.
+    struct ThreadRingOwner
+    {
+        shared_ptr<TraceRing> ring;
+
+        ~ThreadRingOwner()
+        {
+            if (!ring)
+                return;
+            TraceRegistry& r = Registry();
+            lock_guard<mutex> guard(r.lock);
+            uint64_t head = ring->head.load(memory_order_relaxed);
+            if (r.retired.empty() && head > FirstLiveEvent(*ring, head))
+                r.retired.resize(c_traceRingCapacity);
+            for (uint64_t i = FirstLiveEvent(*ring, head); i < head; i++)
+                r.retired[r.retiredHead++ & (c_traceRingCapacity - 1)] = RetiredEvent{ring->events[i & (c_traceRingCapacity - 1)], ring->threadId};
+            r.rings.erase(find(r.rings.begin(), r.rings.end(), ring));
+        }
+    };
+
+    /// The calling thread's ring, registered on first use
+    TraceRing& ThreadRing()
+    {
+        thread_local ThreadRingOwner owner;
+        if (!owner.ring)
+        {
+            owner.ring = make_shared<TraceRing>();
+            TraceRegistry& r = Registry();
+            lock_guard<mutex> guard(r.lock);
+            owner.ring->threadId = r.nextThreadId++;
+            r.rings.push_back(owner.ring);
+        }
+        return *owner.ring;
+    }
+
+    void WriteTraceEvent(ostream& out, size_t& written, const TraceEvent& e, uint32_t threadId)
+    {
+        out << (written++ > 0 ? ",\n" : "\n") << "{\"name\":";
+        WriteJsonString(out, e.name);
+        // Chrome wants microseconds, keep the nanoseconds as decimals
+        char times[64];
+        snprintf(times, sizeof(times), ",\"ts\":%lld.%03lld,\"dur\":%lld.%03lld"
+               , static_cast<long long>(e.beginNs / 1000), static_cast<long long>(e.beginNs % 1000)
+               , static_cast<long long>((e.endNs - e.beginNs) / 1000), static_cast<long long>((e.endNs - e.beginNs) % 1000));
+        out << ",\"cat\":\"ballistics\",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadId << times << '}';
+    }
+}
+
+int64_t TraceNowNs()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void RecordTraceEvent(const char* name, int64_t beginNs, int64_t endNs)
+{
+    TraceRing& ring = ThreadRing();
+    uint64_t h = ring.head.load(memory_order_relaxed);
+    ring.events[h & (c_traceRingCapacity - 1)] = TraceEvent{name, beginNs, endNs};
+    ring.head.store(h + 1, memory_order_release);
+}
+
+const char* InternTraceName(const string& name)
+{
+    TraceRegistry& r = Registry();
+    lock_guard<mutex> guard(r.lock);
+    return r.names.insert(name).first->c_str();
+}
+
+size_t ExportChromeTrace(ostream& out)
+{
+    vector<shared_ptr<TraceRing>> rings;
+    vector<RetiredEvent> retired;
+    {
+        TraceRegistry& r = Registry();
+        lock_guard<mutex> guard(r.lock);
+        rings = r.rings;
+        uint64_t first = max(r.retiredTail, r.retiredHead > c_traceRingCapacity ? r.retiredHead - c_traceRingCapacity : 0);
+        retired.reserve(r.retiredHead - first);
+        for (uint64_t i = first; i < r.retiredHead; i++)
+            retired.push_back(r.retired[i & (c_traceRingCapacity - 1)]);
+    }
+
+    size_t written = 0;
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (const RetiredEvent& e : retired)
+        WriteTraceEvent(out, written, e.event, e.threadId);
+    for (const shared_ptr<TraceRing>& ring : rings)
+    {
+        uint64_t head = ring->head.load(memory_order_acquire);
+        uint64_t first = FirstLiveEvent(*ring, head);
+        vector<TraceEvent> events;
+        events.reserve(head - first);
+        for (uint64_t i = first; i < head; i++)
+            events.push_back(ring->events[i & (c_traceRingCapacity - 1)]);
+
+        // The owner may have lapped the copy while it was taken, drop the slots it could have rewritten
+        uint64_t lapped = ring->head.load(memory_order_acquire);
+        size_t skip = lapped >= first + c_traceRingCapacity ? static_cast<size_t>(min<uint64_t>(lapped - first - c_traceRingCapacity + 1, events.size())) : 0;
+
+        for (size_t i = skip; i < events.size(); i++)
+            WriteTraceEvent(out, written, events[i], ring->threadId);
+    }
+    out << "\n]}\n";
+    return written;
+}
+
+void ClearTrace()
+{
+    TraceRegistry& r = Registry();
+    lock_guard<mutex> guard(r.lock);
+    for (const shared_ptr<TraceRing>& ring : r.rings)
+        ring->tail.store(ring->head.load(memory_order_acquire), memory_order_relaxed);
+    r.retiredTail = r.retiredHead;
+}
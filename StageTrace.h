@@ -0,0 +1,62 @@
+/// Per stage latency tracing
+///
+/// BALLISTICS_TRACE_SCOPE("name") times the rest of the enclosing block when the build defines
+/// BALLISTICS_TRACE (cmake -DBALLISTICS_TRACE=ON) and compiles to nothing otherwise. Each thread
+/// records into its own fixed size ring, so the write path takes no lock and old events are simply
+/// overwritten. When a thread exits its events move into one shared ring of the same size, so pools
+/// that spawn fresh workers keep a bounded footprint. ExportChromeTrace() writes whatever the rings still hold as Chrome trace_event JSON,
+/// which opens in Perfetto (ui.perfetto.dev) or chrome://tracing.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#ifdef BALLISTICS_TRACE
+constexpr bool c_bTraceEnabled = true;
+#else
+constexpr bool c_bTraceEnabled = false;
+#endif
+
+constexpr size_t c_traceRingCapacity = 16384;   // Events kept per thread, a power of 2
+
+/// Steady clock [ns]
+int64_t TraceNowNs();
+
+/// Adds a complete event to the calling thread's ring. name must outlive the trace, use InternTraceName() for runtime strings.
+void RecordTraceEvent(const char* name, int64_t beginNs, int64_t endNs);
+
+/// Stable copy of a runtime stage name, the same pointer for the same string
+const char* InternTraceName(const std::string& name);
+
+/// Writes every thread's events as a Chrome trace_event JSON object
+/// \return Number of events written
+size_t ExportChromeTrace(std::ostream& out);
+
+/// Drops all recorded events
+void ClearTrace();
+
+class ScopedStageTimer
+{
+public:
+    explicit ScopedStageTimer(const char* name) : m_name(name), m_beginNs(TraceNowNs()) {}
+    ~ScopedStageTimer() { RecordTraceEvent(m_name, m_beginNs, TraceNowNs()); }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    const char* m_name;
+    int64_t m_beginNs;
+};
+
+#define BALLISTICS_TRACE_CONCAT2(a, b) a##b
+#define BALLISTICS_TRACE_CONCAT(a, b) BALLISTICS_TRACE_CONCAT2(a, b)
+
+#ifdef BALLISTICS_TRACE
+#define BALLISTICS_TRACE_SCOPE(name) ScopedStageTimer BALLISTICS_TRACE_CONCAT(traceScope, __LINE__)(name)
+#else
+#define BALLISTICS_TRACE_SCOPE(name) ((void)0)
+#endif
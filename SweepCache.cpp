@@ -0,0 +1,184 @@
+#include "SweepCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace
+{
+    constexpr char c_entryExtension[] = ".bvc";
+
+    /// Bump when the entry contents change without the solver changing, e.g. ShotBatchColumns()
+    constexpr uint32_t c_cacheFormat = 2;
+
+    class Fnv1a
+    {
+    public:
+        void Add(const void* data, size_t bytes)
+        {
+            const unsigned char* p = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < bytes; i++)
+            {
+                m_hash ^= p[i];
+                m_hash *= 0x100000001b3ull;
+            }
+        }
+
+        void Add(double value)
+        {
+            // Bit pattern, so the key changes with the last bit of any constant
+            uint64_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            Add(&bits, sizeof(bits));
+        }
+
+        void Add(uint32_t value) { Add(&value, sizeof(value)); }
+
+        uint64_t Value() const { return m_hash; }
+
+    private:
+        uint64_t m_hash = 0xcbf29ce484222325ull;
+    };
+}
+
+uint64_t SweepCacheKey(const ShooterConfig& config, const ShotSweepGrid& grid)
+{
+    Fnv1a h;
+    h.Add(c_cacheFormat);
+    h.Add(c_shotSolverVersion);
+
+    h.Add(config.flywheelMass.value());
+    h.Add(config.flywheelRadius.value());
+    h.Add(config.minAngle.value());
+    h.Add(config.maxAngle.value());
+    h.Add(config.launchHeight.value());
+    h.Add(uint32_t(config.bClampAngle));
+    h.Add(config.flywheelInertiaFrac.value());
+
+    using Piece = DefaultShooterModel::GamePiece;
+    const string model = DefaultShooterModel::Name();
+    h.Add(model.data(), model.size());
+    h.Add(Piece::mass.value());
+    h.Add(Piece::radius.value());
+    h.Add(Piece::inertiaFrac.value());
+    h.Add(DefaultShooterModel::SpeedFactor(1.0, 0.5));
+    h.Add(gravity.value());
+    h.Add(hubRimHeight.value());
+    h.Add(hubConeDiameter.value());
+    h.Add(airDensity.value());
+
+    h.Add(grid.distanceMin.value());
+    h.Add(grid.distanceMax.value());
+    h.Add(grid.distanceStep.value());
+    h.Add(grid.heightAboveHubMin.value());
+    h.Add(grid.heightAboveHubMax.value());
+    h.Add(grid.heightAboveHubStep.value());
+    h.Add(grid.targetDist.value());
+    h.Add(grid.targetHeight.value());
+
+    return h.Value();
+}
+
+SweepCache::SweepCache(string directory, const SweepCacheOptions& options)
+    : m_directory(move(directory))
+    , m_options(options)
+{
+}
+
+string SweepCache::EntryPath(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx%s", static_cast<unsigned long long>(key), c_entryExtension);
+    return (fs::path(m_directory) / name).string();
+}
+
+bool SweepCache::Contains(const ShooterConfig& config, const ShotSweepGrid& grid) const
+{
+    error_code ec;
+    return fs::is_regular_file(EntryPath(SweepCacheKey(config, grid)), ec);
+}
+
+bool SweepCache::Open(const ShooterConfig& config, const ShotSweepGrid& grid, ColumnFileReader& reader, unsigned threads)
+{
+    reader.Close();
+    const string path = EntryPath(SweepCacheKey(config, grid));
+
+    error_code ec;
+    if (fs::is_regular_file(path, ec))
+    {
+        // Touch before mapping, Windows will not set the time on a mapped file
+        fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+        if (reader.Open(path))
+        {
+            m_hits++;
+            return true;
+        }
+        // Unreadable, e.g. written by an older build with the same key, solve it again
+        fs::remove(path, ec);
+    }
+
+    m_misses++;
+    fs::create_directories(m_directory, ec);
+
+    const string temp = path + ".tmp";
+    if (!WriteShotSweepColumns(config, grid, temp, threads))
+    {
+        fs::remove(temp, ec);
+        return false;
+    }
+    fs::rename(temp, path, ec);
+    if (ec)
+    {
+        fs::remove(temp, ec);
+        return false;
+    }
+
+    Evict(path);
+    return reader.Open(path);
+}
+
+void SweepCache::Evict(const string& keep)
+{
+    struct Entry
+    {
+        fs::path path;
+        fs::file_time_type used;
+        uint64_t bytes;
+    };
+
+    error_code ec;
+    vector<Entry> entries;
+    uint64_t total = 0;
+    for (fs::directory_iterator it(m_directory, ec), end; !ec && it != end; it.increment(ec))
+    {
+        error_code entryEc;
+        const fs::path& path = it->path();
+        if (path.extension() != c_entryExtension || !it->is_regular_file(entryEc))
+            continue;
+
+        Entry e{ path, it->last_write_time(entryEc), it->file_size(entryEc) };
+        if (entryEc)
+            continue;
+        total += e.bytes;
+        entries.push_back(move(e));
+    }
+
+    sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.used < b.used; });
+    const fs::path kept = keep;
+    for (const Entry& e : entries)
+    {
+        if (total <= m_options.maxBytes)
+            break;
+        if (!keep.empty() && e.path == kept)
+            continue;
+        // An entry another process has mapped may refuse to go, it is retried on the next eviction
+        if (fs::remove(e.path, ec))
+            total -= e.bytes;
+    }
+}
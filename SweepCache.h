@@ -0,0 +1,60 @@
+/// On-disk cache of solved sweeps
+///
+/// A sweep's results depend only on the shooter configuration, the game piece and flywheel arrangement
+/// of DefaultShooterModel, the field constants in BallisticsConstants.h, the grid and the solver
+/// equations. SweepCacheKey() hashes all of them, and
+/// the sweep is stored as a column file (ColumnFile.h) named after the hash, so an unchanged
+/// configuration maps its previous results instead of solving again. Entries are written to a
+/// temporary name and renamed into place, so a crash never leaves a partial entry behind.
+///
+/// Each hit refreshes the entry's modification time. When the directory grows past its byte budget
+/// the entries with the oldest times go first, which makes the eviction least recently used.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "ColumnFile.h"
+#include "ShotSolver.h"
+#include "SweepWriter.h"
+
+/// 64 bit FNV-1a of the configuration, DefaultShooterModel, the physical constants, the grid and c_shotSolverVersion
+uint64_t SweepCacheKey(const ShooterConfig& config, const ShotSweepGrid& grid);
+
+struct SweepCacheOptions
+{
+    uint64_t maxBytes = uint64_t(256) << 20;    //!< Entries past this are evicted, least recently used first
+};
+
+class SweepCache
+{
+public:
+    /// \param directory    Created on first use
+    explicit SweepCache(std::string directory, const SweepCacheOptions& options = SweepCacheOptions());
+
+    const std::string& Directory() const { return m_directory; }
+
+    /// Entry file for a key, whether or not it exists
+    std::string EntryPath(uint64_t key) const;
+
+    bool Contains(const ShooterConfig& config, const ShotSweepGrid& grid) const;
+
+    /// Maps the cached sweep into reader, solving and storing it first on a miss
+    /// \param threads  0 uses std::thread::hardware_concurrency()
+    /// \return False if the sweep could neither be loaded nor stored
+    bool Open(const ShooterConfig& config, const ShotSweepGrid& grid, ColumnFileReader& reader, unsigned threads = 0);
+
+    /// Removes the least recently used entries until the rest fit in the byte budget
+    /// \param keep     Entry never removed, e.g. the one just stored
+    void Evict(const std::string& keep = std::string());
+
+    uint64_t Hits() const { return m_hits; }
+    uint64_t Misses() const { return m_misses; }
+
+private:
+    std::string m_directory;
+    SweepCacheOptions m_options;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+};
@@ -0,0 +1,240 @@
+#include "SweepWriter.h"
+
+#include <array>
+
+#include "Parallel.h"
+
+using namespace std;
+
+SweepWriter::SweepWriter(const string& path, const SweepWriterOptions& options)
+    : m_options(options)
+{
+    m_options.window = max<size_t>(m_options.window, 1);
+    m_options.chunkBytes = max<size_t>(m_options.chunkBytes, 1);
+
+    if (path == "-")
+    {
+        m_file = stdout;
+    }
+    else
+    {
+        m_file = fopen(path.c_str(), "wb");
+        m_bOwnsFile = m_file != nullptr;
+    }
+    if (m_file == nullptr)
+        return;
+
+    // Writes are already whole chunks, stdio buffering would only add a copy. stdout may have been
+    // written to already, so it keeps its buffer and is flushed with every chunk instead.
+    if (m_bOwnsFile)
+        setvbuf(m_file, nullptr, _IONBF, 0);
+
+    m_slots.resize(m_options.window);
+    m_bFilled.assign(m_options.window, false);
+    m_pending.reserve(2 * m_options.chunkBytes);
+    m_writer = thread(&SweepWriter::WriterLoop, this);
+}
+
+SweepWriter::~SweepWriter()
+{
+    Close();
+}
+
+void SweepWriter::Submit(uint64_t sequence, string text)
+{
+    if (m_file == nullptr)
+        return;
+
+    unique_lock<mutex> guard(m_lock);
+    m_slotFreed.wait(guard, [&] { return sequence < m_next + m_options.window || m_bClosing; });
+    if (m_bClosing || sequence < m_next)
+        return;
+
+    size_t slot = sequence % m_options.window;
+    m_slots[slot] = move(text);
+    m_bFilled[slot] = true;
+    if (sequence == m_next)
+        m_slotFilled.notify_one();
+}
+
+bool SweepWriter::Close()
+{
+    if (m_file == nullptr)
+        return false;
+
+    {
+        lock_guard<mutex> guard(m_lock);
+        m_bClosing = true;
+    }
+    m_slotFilled.notify_one();
+    m_slotFreed.notify_all();
+    if (m_writer.joinable())
+        m_writer.join();
+
+    fflush(m_file);
+    if (m_bOwnsFile && fclose(m_file) != 0)
+        m_bWriteFailed = true;
+    m_file = nullptr;
+    return !m_bWriteFailed && !m_bMissingBlocks;
+}
+
+void SweepWriter::WriterLoop()
+{
+    for (;;)
+    {
+        string block;
+        {
+            unique_lock<mutex> guard(m_lock);
+            size_t slot = m_next % m_options.window;
+            m_slotFilled.wait(guard, [&] { return m_bFilled[slot] || m_bClosing; });
+            if (!m_bFilled[slot])
+            {
+                // Closing: anything still buffered sits behind a block that never arrived
+                for (bool bFilled : m_bFilled)
+                    m_bMissingBlocks = m_bMissingBlocks || bFilled;
+                break;
+            }
+            block = move(m_slots[slot]);
+            m_slots[slot] = string();
+            m_bFilled[slot] = false;
+            m_next++;
+        }
+        m_slotFreed.notify_all();
+
+        m_pending.insert(m_pending.end(), block.begin(), block.end());
+        if (m_pending.size() >= m_options.chunkBytes)
+            WriteChunks(false);
+    }
+    WriteChunks(true);
+}
+
+void SweepWriter::WriteChunks(bool bFinal)
+{
+    size_t bytes = bFinal ? m_pending.size() : m_pending.size() - m_pending.size() % m_options.chunkBytes;
+    if (bytes == 0)
+        return;
+
+    if (!m_bWriteFailed)
+    {
+        size_t written = fwrite(m_pending.data(), 1, bytes, m_file);
+        m_bytesWritten += written;
+        m_bWriteFailed = written != bytes || fflush(m_file) != 0;
+    }
+    m_pending.erase(m_pending.begin(), m_pending.begin() + bytes);
+}
+
+namespace
+{
+    const CsvFormat& ShotBatchCsvFormat()
+    {
+        static const CsvFormat format({
+            { "distance [m]", 4 },
+            { "targetDist [m]", 4 },
+            { "heightAboveHub [m]", 4 },
+            { "targetHeight [m]", 4 },
+            { "rpm", 1 },
+            { "angleInit [deg]", 3 },
+            { "landingAngle [deg]", 3 },
+            { "timeOfFlight [s]", 4 },
+        });
+        return format;
+    }
+}
+
+void FormatShotBatchCsv(const ShotBatchInputs& inputs, const ShotBatchResults& results, bool bSolvedOnly, string& out)
+{
+    const CsvFormat& format = ShotBatchCsvFormat();
+    array<char, 1024> storage;
+    TextBuffer row(storage);
+
+    out.reserve(out.size() + results.Size() * 64);
+    for (size_t i = 0; i < results.Size(); i++)
+    {
+        bool bSolved = results.status[i] <= c_shotClamped;
+        if (bSolvedOnly && !bSolved)
+            continue;
+
+        size_t lane = results.lane[i];
+        const double values[] =
+        {
+            inputs.distance[lane], inputs.targetDist[lane], inputs.heightAboveHub[lane], inputs.targetHeight[lane],
+            results.rpm[i], results.angleInit[i], results.landingAngle[i], results.timeOfFlight[i]
+        };
+
+        row.Clear();
+        format.WriteRow(row, values);
+        if (!bSolvedOnly)
+        {
+            row.Append(',');
+            row.Append(ShotStatusName(static_cast<ShotStatus>(results.status[i])));
+        }
+        row.Append('\n');
+        out.append(row.View());
+    }
+}
+
+string ShotBatchCsvHeader(bool bSolvedOnly)
+{
+    return ShotBatchCsvFormat().Header() + (bSolvedOnly ? "\n" : ",status\n");
+}
+
+size_t ShotSweepGrid::Rows() const
+{
+    return Steps(distanceMin, distanceMax, distanceStep);
+}
+
+size_t ShotSweepGrid::Columns() const
+{
+    return Steps(heightAboveHubMin, heightAboveHubMax, heightAboveHubStep);
+}
+
+void ShotSweepGrid::RowInputs(size_t row, ShotBatchInputs& inputs) const
+{
+    const size_t columns = Columns();
+    inputs = ShotBatchInputs();
+    inputs.Reserve(columns);
+    for (size_t c = 0; c < columns; c++)
+    {
+        ShotInputs in;
+        in.distance = distanceMin + static_cast<double>(row) * distanceStep;
+        in.targetDist = targetDist;
+        in.heightAboveHub = heightAboveHubMin + static_cast<double>(c) * heightAboveHubStep;
+        in.targetHeight = targetHeight;
+        inputs.Add(in);
+    }
+}
+
+size_t ShotSweepGrid::Steps(meter_t lo, meter_t hi, meter_t step)
+{
+    return step > meter_t(0.0) && hi >= lo ? static_cast<size_t>((hi - lo) / step + 1e-9) + 1 : size_t(1);
+}
+
+bool WriteShotSweep(const ShooterConfig& config, const ShotSweepGrid& grid, SweepWriter& writer, bool bSolvedOnly, unsigned threads)
+{
+    const size_t rows = grid.Rows();
+    writer.Submit(0, ShotBatchCsvHeader(bSolvedOnly));
+
+    // Rows are dealt out round robin so every worker stays inside the writer's window
+    if (threads == 0)
+        threads = DefaultThreadCount();
+    threads = static_cast<unsigned>(std::min<size_t>(threads, rows));
+    ParallelFor(threads, threads, [&](size_t begin, size_t end, unsigned)
+    {
+        ShotBatchInputs inputs;
+        ShotBatchResults results;
+        for (size_t worker = begin; worker < end; worker++)
+        {
+            for (size_t row = worker; row < rows; row += threads)
+            {
+                grid.RowInputs(row, inputs);
+                SolveShotBatch(config, inputs, results);
+
+                string text;
+                FormatShotBatchCsv(inputs, results, bSolvedOnly, text);
+                writer.Submit(row + 1, move(text));
+            }
+        }
+    });
+
+    return writer.Close();
+}
@@ -0,0 +1,108 @@
+/// Streaming output for sweeps
+///
+/// Worker threads format their part of a sweep into text blocks and Submit() them with a sequence
+/// number; a writer thread puts the blocks back in sequence order and writes them to a file or stdout
+/// in whole chunks. Only a window of blocks past the next one to write is buffered: a producer that
+/// gets that far ahead blocks until the writer catches up, so a slow sink or a slow early block holds
+/// the workers back instead of the sweep piling up in memory. The block the writer waits for always
+/// fits in the window, so producers cannot deadlock each other.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CsvFormat.h"
+#include "ShotBatch.h"
+
+struct SweepWriterOptions
+{
+    size_t window = 64;                     //!< Blocks buffered ahead of the next one to write
+    size_t chunkBytes = size_t(1) << 20;    //!< Writes are whole multiples of this, except the last
+};
+
+class SweepWriter
+{
+public:
+    /// \param path     File to create, "-" for stdout
+    explicit SweepWriter(const std::string& path, const SweepWriterOptions& options = SweepWriterOptions());
+    ~SweepWriter();
+
+    SweepWriter(const SweepWriter&) = delete;
+    SweepWriter& operator=(const SweepWriter&) = delete;
+
+    bool IsOpen() const { return m_file != nullptr; }
+
+    /// Queues block sequence (0, 1, 2, ...) for writing, blocking while it is a window or more ahead
+    /// of the next block to write. Every sequence number must be submitted exactly once.
+    void Submit(uint64_t sequence, std::string text);
+
+    /// Writes everything queued up to the first missing sequence number and closes the sink. Call it
+    /// once every Submit() has returned.
+    /// \return False if a block was missing or a write failed
+    bool Close();
+
+    uint64_t BytesWritten() const { return m_bytesWritten; }
+
+private:
+    void WriterLoop();
+    void WriteChunks(bool bFinal);
+
+    SweepWriterOptions m_options;
+    FILE* m_file = nullptr;
+    bool m_bOwnsFile = false;
+
+    std::mutex m_lock;                      //!< Guards the slots, m_next and m_bClosing
+    std::condition_variable m_slotFilled;
+    std::condition_variable m_slotFreed;
+    std::vector<std::string> m_slots;       //!< Block sequence s waits in m_slots[s % window]
+    std::vector<bool> m_bFilled;
+    uint64_t m_next = 0;                    //!< Next sequence to write
+    bool m_bClosing = false;
+
+    std::vector<char> m_pending;            //!< Writer thread only, text not yet written
+    uint64_t m_bytesWritten = 0;
+    bool m_bWriteFailed = false;
+    bool m_bMissingBlocks = false;
+    std::thread m_writer;
+};
+
+/// Appends one CSV row per solved lane: the four inputs [m] then rpm, launch angle [deg], landing angle
+/// [deg] and time of flight [s]. Failed lanes are left out when bSolvedOnly, otherwise written with
+/// their ShotStatus in a last column.
+void FormatShotBatchCsv(const ShotBatchInputs& inputs, const ShotBatchResults& results, bool bSolvedOnly, std::string& out);
+
+/// Header line matching FormatShotBatchCsv()
+std::string ShotBatchCsvHeader(bool bSolvedOnly);
+
+/// Distance by height above hub grid for WriteShotSweep(), both ends included
+struct ShotSweepGrid
+{
+    meter_t distanceMin = meter_t(0.5);
+    meter_t distanceMax = meter_t(8.0);
+    meter_t distanceStep = meter_t(0.005);
+    meter_t heightAboveHubMin = meter_t(hubRimHeight) + meter_t(0.05);
+    meter_t heightAboveHubMax = meter_t(hubRimHeight) + meter_t(1.0);
+    meter_t heightAboveHubStep = meter_t(0.005);
+    meter_t targetDist = defaultTargetDist;
+    meter_t targetHeight = defaultTargetHeight;
+
+    size_t Rows() const;        //!< Distances
+    size_t Columns() const;     //!< Heights above hub
+    /// Every height above hub at one distance
+    void RowInputs(size_t row, ShotBatchInputs& inputs) const;
+
+private:
+    static size_t Steps(meter_t lo, meter_t hi, meter_t step);
+};
+
+/// Solves the grid with SolveShotBatch(), one distance per block, and streams it through the writer,
+/// which is closed on return
+/// \param threads  0 uses std::thread::hardware_concurrency()
+/// \return SweepWriter::Close()
+bool WriteShotSweep(const ShooterConfig& config, const ShotSweepGrid& grid, SweepWriter& writer, bool bSolvedOnly = true, unsigned threads = 0);
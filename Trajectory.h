@@ -0,0 +1,176 @@
+/// Drag-aware fuel trajectory simulation
+///
+/// The Calculations solver assumes a drag-free parabola. This integrates the flight with quadratic
+/// drag and Magnus lift from backspin so logged shots can be compared against the model.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "BallisticsConstants.h"
+#include "Dual.h"
+
+/// Aerodynamic coefficients for the game piece
+struct DragCoefficients
+{
+    double cd = 0.47;   //!< Drag coefficient, 0.47 is a smooth sphere
+    double cl = 0.0;    //!< Lift coefficient from backspin (Magnus)
+};
+
+/// Launch conditions in SI units, measured from the launch point
+template <typename T>
+struct LaunchConditions
+{
+    T velInit;              //!< Exit velocity [m/s]
+    T angleInit;            //!< Launch angle above horizontal [rad]
+    double landingHeight;   //!< Height of the landing plane relative to the launch point [m]
+};
+
+template <typename T>
+struct TrajectoryResult
+{
+    T landingDist = T(0.0);     //!< Horizontal distance where the fuel descends through the landing plane [m]
+    T timeOfFlight = T(0.0);    //!< [s]
+    T maxHeight = T(0.0);       //!< Apex relative to the launch point [m]
+    T landingVelX = T(0.0);     //!< [m/s]
+    T landingVelY = T(0.0);     //!< [m/s]
+    bool bLanded = false;       //!< False if the fuel never came back down through the landing plane
+};
+
+/// Fixed step RK4 integration settings
+constexpr double c_trajectoryTimeStep = 0.002;  // [s]
+constexpr double c_trajectoryMaxTime = 5.0;     // [s]
+
+/// 1/2 rho A / m of the fuel, see ShooterModel::c_aeroPerMass for other game pieces
+constexpr double c_fuelAeroPerMass = 0.5 * airDensity.value() * fuelCrossSection.value() / fuelMass.value();
+
+/// Per unit mass drag and lift constants, 1/2 rho C A / m
+template <typename T>
+struct AeroConstants
+{
+    T kDrag;
+    T kLift;
+
+    AeroConstants(const T& cd, const T& cl, double aeroPerMass = c_fuelAeroPerMass)
+    {
+        kDrag = cd * aeroPerMass;
+        kLift = cl * aeroPerMass;
+    }
+};
+
+template <typename T>
+struct TrajectoryState
+{
+    T x, y, vx, vy;
+};
+
+/// Equations of motion: gravity, drag opposing velocity, lift perpendicular to velocity (backspin lifts)
+template <typename T>
+inline TrajectoryState<T> TrajectoryDerivative(const TrajectoryState<T>& s, const AeroConstants<T>& aero)
+{
+    using std::sqrt;
+    T speed = sqrt(s.vx * s.vx + s.vy * s.vy);
+    TrajectoryState<T> ds;
+    ds.x = s.vx;
+    ds.y = s.vy;
+    ds.vx = -aero.kDrag * speed * s.vx - aero.kLift * speed * s.vy;
+    ds.vy = -aero.kDrag * speed * s.vy + aero.kLift * speed * s.vx - gravity.value();
+    return ds;
+}
+
+template <typename T>
+inline TrajectoryState<T> TrajectoryStep(const TrajectoryState<T>& s, const AeroConstants<T>& aero, double dt)
+{
+    auto axpy = [](const TrajectoryState<T>& a, const TrajectoryState<T>& b, double h)
+    {
+        return TrajectoryState<T>{a.x + b.x * h, a.y + b.y * h, a.vx + b.vx * h, a.vy + b.vy * h};
+    };
+
+    TrajectoryState<T> k1 = TrajectoryDerivative(s, aero);
+    TrajectoryState<T> k2 = TrajectoryDerivative(axpy(s, k1, 0.5 * dt), aero);
+    TrajectoryState<T> k3 = TrajectoryDerivative(axpy(s, k2, 0.5 * dt), aero);
+    TrajectoryState<T> k4 = TrajectoryDerivative(axpy(s, k3, dt), aero);
+
+    double h6 = dt / 6.0;
+    return TrajectoryState<T>{ s.x + (k1.x + 2.0 * k2.x + 2.0 * k3.x + k4.x) * h6
+                             , s.y + (k1.y + 2.0 * k2.y + 2.0 * k3.y + k4.y) * h6
+                             , s.vx + (k1.vx + 2.0 * k2.vx + 2.0 * k3.vx + k4.vx) * h6
+                             , s.vy + (k1.vy + 2.0 * k2.vy + 2.0 * k3.vy + k4.vy) * h6 };
+}
+
+/// Simulates a batch of shots in lock step until every one has descended through its landing plane.
+/// A shot whose apex stays below the plane is left with bLanded false.
+/// T may be double or Dual<N>; with Dual the results carry derivatives wrt whatever was seeded
+/// in the launch conditions or aerodynamic coefficients.
+template <typename T>
+void SimulateTrajectoryBatch(const std::vector<LaunchConditions<T>>& launches
+                           , const T& cd
+                           , const T& cl
+                           , std::vector<TrajectoryResult<T>>& results
+                           , double dt = c_trajectoryTimeStep
+                           , double aeroPerMass = c_fuelAeroPerMass)
+{
+    using std::cos;
+    using std::sin;
+
+    AeroConstants<T> aero(cd, cl, aeroPerMass);
+    size_t count = launches.size();
+    results.assign(count, TrajectoryResult<T>{});
+
+    std::vector<TrajectoryState<T>> states(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        const LaunchConditions<T>& l = launches[i];
+        states[i] = TrajectoryState<T>{T(0.0), T(0.0), l.velInit * cos(l.angleInit), l.velInit * sin(l.angleInit)};
+    }
+
+    // Landed, or peaked below the landing plane and can no longer reach it
+    std::vector<char> bDone(count, 0);
+    size_t remaining = count;
+    int maxSteps = static_cast<int>(c_trajectoryMaxTime / dt);
+    for (int step = 1; step <= maxSteps && remaining > 0; step++)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            TrajectoryResult<T>& r = results[i];
+            if (bDone[i])
+                continue;
+
+            TrajectoryState<T> prev = states[i];
+            TrajectoryState<T> next = TrajectoryStep(prev, aero, dt);
+            states[i] = next;
+
+            if (ValueOf(next.y) > ValueOf(r.maxHeight))
+                r.maxHeight = next.y;
+
+            double h = launches[i].landingHeight;
+            if (ValueOf(next.vy) >= 0.0 || ValueOf(next.y) > h)
+                continue;
+
+            bDone[i] = 1;
+            remaining--;
+            if (ValueOf(prev.y) > h)
+            {
+                // Linear interpolation to the plane crossing within the last step
+                T frac = (prev.y - h) / (prev.y - next.y);
+                r.landingDist = prev.x + (next.x - prev.x) * frac;
+                r.timeOfFlight = (static_cast<double>(step - 1) + frac) * dt;
+                r.landingVelX = prev.vx + (next.vx - prev.vx) * frac;
+                r.landingVelY = prev.vy + (next.vy - prev.vy) * frac;
+                r.bLanded = true;
+            }
+        }
+    }
+}
+
+/// Single shot convenience wrapper around SimulateTrajectoryBatch()
+template <typename T>
+TrajectoryResult<T> SimulateTrajectory(const LaunchConditions<T>& launch, const T& cd, const T& cl, double dt = c_trajectoryTimeStep)
+{
+    std::vector<LaunchConditions<T>> launches{launch};
+    std::vector<TrajectoryResult<T>> results;
+    SimulateTrajectoryBatch(launches, cd, cl, results, dt);
+    return results[0];
+}
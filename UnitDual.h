@@ -0,0 +1,256 @@
+/// Forward-mode automatic differentiation for units::unit_t quantities
+///
+/// The vendored units library rebuilds compound results as unit_t<..., double>, so a
+/// unit_t<meter, Dual<N>> loses its derivatives on the first multiply. UnitDual instead keeps the
+/// value and each partial derivative as unit_t of the same type, and lets the units library do
+/// the dimensional analysis and conversions on both. A partial derivative is "units of the value
+/// per unit of the seed variable", e.g. rpm per meter when the seed was a meter_t.
+///
+/// Quantity<S, U> picks the storage for a unit type U given a scalar kind S, so solver code
+/// templated on S runs as plain unit_t (S = double) or with derivatives (S = Dual<N>).
+
+#pragma once
+
+#include <array>
+#include <type_traits>
+
+#include "units/units.h"
+#include "Dual.h"
+
+template <class UnitType, int N>
+struct UnitDual
+{
+    UnitType val{};
+    std::array<UnitType, N> d{};
+
+    constexpr UnitDual() = default;
+    constexpr UnitDual(const UnitType& v) : val(v) {}
+
+    /// Conversion between compatible units, e.g. a compound length from an apex fit to meter_t
+    template <class U2, std::enable_if_t<!std::is_same<U2, UnitType>::value && units::traits::is_convertible_unit_t<U2, UnitType>::value, int> = 0>
+    constexpr UnitDual(const UnitDual<U2, N>& o) : val(o.val)
+    {
+        for (int i = 0; i < N; i++) d[i] = o.d[i];
+    }
+
+    /// Seed variable number idx, d[idx] = 1 of the value's own unit
+    static UnitDual Variable(const UnitType& v, int idx)
+    {
+        UnitDual r(v);
+        r.d[idx] = UnitType(1.0);
+        return r;
+    }
+
+    double value() const { return val.value(); }
+};
+
+template <class T> struct is_unit_dual : std::false_type {};
+template <class U, int N> struct is_unit_dual<UnitDual<U, N>> : std::true_type {};
+
+/// Storage type for unit U when the solver runs with scalar kind S
+template <class S, class U> struct QuantityOf { using type = U; };
+template <int N, class U> struct QuantityOf<Dual<N>, U> { using type = UnitDual<U, N>; };
+template <class S, class U> using Quantity = typename QuantityOf<S, U>::type;
+
+/// Value part of a plain or dual quantity
+template <class U, std::enable_if_t<units::traits::is_unit_t<U>::value, int> = 0>
+inline double ValueOf(const U& q) { return q.value(); }
+template <class U, int N> inline double ValueOf(const UnitDual<U, N>& q) { return q.value(); }
+
+//------------------------------------------------------------------------------
+// Arithmetic, dual with dual
+
+template <class A, class B, int N>
+inline auto operator+(const UnitDual<A, N>& a, const UnitDual<B, N>& b)
+{
+    UnitDual<decltype(a.val + b.val), N> r(a.val + b.val);
+    for (int i = 0; i < N; i++) r.d[i] = a.d[i] + b.d[i];
+    return r;
+}
+
+template <class A, class B, int N>
+inline auto operator-(const UnitDual<A, N>& a, const UnitDual<B, N>& b)
+{
+    UnitDual<decltype(a.val - b.val), N> r(a.val - b.val);
+    for (int i = 0; i < N; i++) r.d[i] = a.d[i] - b.d[i];
+    return r;
+}
+
+template <class A, int N>
+inline UnitDual<A, N> operator-(const UnitDual<A, N>& a)
+{
+    UnitDual<A, N> r(-a.val);
+    for (int i = 0; i < N; i++) r.d[i] = -a.d[i];
+    return r;
+}
+
+template <class A, class B, int N>
+inline auto operator*(const UnitDual<A, N>& a, const UnitDual<B, N>& b)
+{
+    UnitDual<decltype(a.val * b.val), N> r(a.val * b.val);
+    for (int i = 0; i < N; i++) r.d[i] = a.d[i] * b.val + a.val * b.d[i];
+    return r;
+}
+
+template <class A, class B, int N>
+inline auto operator/(const UnitDual<A, N>& a, const UnitDual<B, N>& b)
+{
+    using R = decltype(a.val / b.val);
+    UnitDual<R, N> r(a.val / b.val);
+    for (int i = 0; i < N; i++) r.d[i] = R(a.d[i] / b.val) - r.val * (b.d[i] / b.val);
+    return r;
+}
+
+//------------------------------------------------------------------------------
+// Arithmetic with constants (plain unit_t or arithmetic), constants have zero derivative
+
+template <class A, int N, class K, std::enable_if_t<!is_unit_dual<K>::value, int> = 0>
+inline auto operator+(const UnitDual<A, N>& a, const K& k)
+{
+    UnitDual<decltype(a.val + k), N> r(a.val + k);
+    for (int i = 0; i < N; i++) r.d[i] = a.d[i];
+    return r;
+}
+
+template <class A, int N, class K, std::enable_if_t<!is_unit_dual<K>::value, int> = 0>
+inline auto operator+(const K& k, const UnitDual<A, N>& a)
+{
+    UnitDual<decltype(k + a.val), N> r(k + a.val);
+    for (int i = 0; i < N; i++) r.d[i] = a.d[i];
+    return r;
+}
+
+template <class A, int N, class K, std::enable_if_t<!is_unit_dual<K>::value, int> = 0>
+inline auto operator-(const UnitDual<A, N>& a, const K& k)
+{
+    UnitDual<decltype(a.val - k), N> r(a.val - k);
+    for (int i = 0; i < N; i++) r.d[i] = a.d[i];
+    return r;
+}
+
+template <class A, int N, class K, std::enable_if_t<!is_unit_dual<K>::value, int> = 0>
+inline auto operator-(const K& k, const UnitDual<A, N>& a)
+{
+    UnitDual<decltype(k - a.val), N> r(k - a.val);
+    for (int i = 0; i < N; i++) r.d[i] = -a.d[i];
+    return r;
+}
+
+template <class A, int N, class K, std::enable_if_t<!is_unit_dual<K>::value, int> = 0>
+inline auto operator*(const UnitDual<A, N>& a, const K& k)
+{
+    UnitDual<decltype(a.val * k), N> r(a.val * k);
+    for (int i = 0; i < N; i++) r.d[i] = a.d[i] * k;
+    return r;
+}
+
+template <class A, int N, class K, std::enable_if_t<!is_unit_dual<K>::value, int> = 0>
+inline auto operator*(const K& k, const UnitDual<A, N>& a)
+{
+    UnitDual<decltype(k * a.val), N> r(k * a.val);
+    for (int i = 0; i < N; i++) r.d[i] = k * a.d[i];
+    return r;
+}
+
+template <class A, int N, class K, std::enable_if_t<!is_unit_dual<K>::value, int> = 0>
+inline auto operator/(const UnitDual<A, N>& a, const K& k)
+{
+    UnitDual<decltype(a.val / k), N> r(a.val / k);
+    for (int i = 0; i < N; i++) r.d[i] = a.d[i] / k;
+    return r;
+}
+
+template <class A, int N, class K, std::enable_if_t<!is_unit_dual<K>::value, int> = 0>
+inline auto operator/(const K& k, const UnitDual<A, N>& a)
+{
+    using R = decltype(k / a.val);
+    UnitDual<R, N> r(k / a.val);
+    for (int i = 0; i < N; i++) r.d[i] = -r.val * (a.d[i] / a.val);
+    return r;
+}
+
+// Comparisons look only at the value so control flow matches the plain path
+template <class A, class B, int N> inline bool operator<(const UnitDual<A, N>& a, const UnitDual<B, N>& b) { return a.val < b.val; }
+template <class A, class B, int N> inline bool operator>(const UnitDual<A, N>& a, const UnitDual<B, N>& b) { return a.val > b.val; }
+template <class A, int N, class K, std::enable_if_t<!is_unit_dual<K>::value, int> = 0> inline bool operator<(const UnitDual<A, N>& a, const K& k) { return a.val < k; }
+template <class A, int N, class K, std::enable_if_t<!is_unit_dual<K>::value, int> = 0> inline bool operator>(const UnitDual<A, N>& a, const K& k) { return a.val > k; }
+template <class A, int N, class K, std::enable_if_t<!is_unit_dual<K>::value, int> = 0> inline bool operator<=(const UnitDual<A, N>& a, const K& k) { return a.val <= k; }
+template <class A, int N, class K, std::enable_if_t<!is_unit_dual<K>::value, int> = 0> inline bool operator>=(const UnitDual<A, N>& a, const K& k) { return a.val >= k; }
+
+//------------------------------------------------------------------------------
+// units::math overloads, picked over the generic unit_t templates by partial ordering
+
+namespace units
+{
+    namespace math
+    {
+        template <class U, int N>
+        inline auto sqrt(const UnitDual<U, N>& a)
+        {
+            using R = decltype(units::math::sqrt(a.val));
+            UnitDual<R, N> r(units::math::sqrt(a.val));
+            for (int i = 0; i < N; i++) r.d[i] = R(a.d[i] / (2.0 * r.val));
+            return r;
+        }
+
+        template <class U, int N>
+        inline UnitDual<dimensionless::scalar_t, N> sin(const UnitDual<U, N>& a)
+        {
+            UnitDual<dimensionless::scalar_t, N> r(units::math::sin(a.val));
+            dimensionless::scalar_t c = units::math::cos(a.val);
+            for (int i = 0; i < N; i++) r.d[i] = c * a.d[i].template convert<angle::radian>().value();
+            return r;
+        }
+
+        template <class U, int N>
+        inline UnitDual<dimensionless::scalar_t, N> cos(const UnitDual<U, N>& a)
+        {
+            UnitDual<dimensionless::scalar_t, N> r(units::math::cos(a.val));
+            dimensionless::scalar_t s = units::math::sin(a.val);
+            for (int i = 0; i < N; i++) r.d[i] = -s * a.d[i].template convert<angle::radian>().value();
+            return r;
+        }
+
+        template <class U, int N>
+        inline UnitDual<dimensionless::scalar_t, N> tan(const UnitDual<U, N>& a)
+        {
+            UnitDual<dimensionless::scalar_t, N> r(units::math::tan(a.val));
+            double sec2 = 1.0 + r.value() * r.value();
+            for (int i = 0; i < N; i++) r.d[i] = sec2 * a.d[i].template convert<angle::radian>().value();
+            return r;
+        }
+
+        template <class U, int N>
+        inline UnitDual<angle::radian_t, N> atan(const UnitDual<U, N>& a)
+        {
+            UnitDual<angle::radian_t, N> r(units::math::atan(a.val));
+            double inv = 1.0 / (1.0 + a.value() * a.value());
+            for (int i = 0; i < N; i++) r.d[i] = angle::radian_t(inv * a.d[i].value());
+            return r;
+        }
+
+        template <class Y, class X, int N>
+        inline UnitDual<angle::radian_t, N> atan2(const UnitDual<Y, N>& y, const UnitDual<X, N>& x)
+        {
+            UnitDual<angle::radian_t, N> r(units::math::atan2(y.val, x.val));
+            // d atan2 = (x dy - y dx) / (x^2 + y^2), evaluated in y's units
+            double xv = Y(x.val).value();
+            double yv = y.value();
+            double inv = 1.0 / (xv * xv + yv * yv);
+            for (int i = 0; i < N; i++) r.d[i] = angle::radian_t((xv * y.d[i].value() - yv * Y(x.d[i]).value()) * inv);
+            return r;
+        }
+
+        template <class U, int N>
+        inline auto hypot(const UnitDual<U, N>& x, const UnitDual<U, N>& y)
+        {
+            return units::math::sqrt(x * x + y * y);
+        }
+
+        template <class U, int N>
+        inline UnitDual<U, N> abs(const UnitDual<U, N>& a)
+        {
+            return a.val < U(0.0) ? -a : a;
+        }
+    }
+}
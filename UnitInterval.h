@@ -0,0 +1,246 @@
+/// Interval arithmetic for units::unit_t quantities
+///
+/// Same approach as UnitDual.h: the bounds are kept as unit_t of the same type so the units library
+/// does the dimensional analysis and conversions, and every result is padded outward (see Interval.h).
+/// Quantity<Interval, U> maps to UnitInterval<U>, so solver code templated on its scalar kind gives
+/// guaranteed enclosures of its outputs over a box of inputs.
+
+#pragma once
+
+#include <algorithm>
+#include <type_traits>
+
+#include "units/units.h"
+#include "Interval.h"
+#include "UnitDual.h"
+
+template <class UnitType>
+struct UnitInterval
+{
+    UnitType lo{};
+    UnitType hi{};
+
+    constexpr UnitInterval() = default;
+    constexpr UnitInterval(const UnitType& v) : lo(v), hi(v) {}
+    constexpr UnitInterval(const UnitType& l, const UnitType& h) : lo(l), hi(h) {}
+
+    /// Conversion between compatible units, e.g. radian_t from atan() to degree_t
+    template <class U2, std::enable_if_t<!std::is_same<U2, UnitType>::value && units::traits::is_convertible_unit_t<U2, UnitType>::value, int> = 0>
+    constexpr UnitInterval(const UnitInterval<U2>& o) : lo(o.lo), hi(o.hi) {}
+
+    /// Nominal value plus or minus a tolerance
+    static UnitInterval Around(const UnitType& nominal, const UnitType& tolerance) { return UnitInterval(nominal - tolerance, nominal + tolerance); }
+
+    /// Bounds computed in round to nearest, padded outward
+    static UnitInterval Outward(const UnitType& l, const UnitType& h) { return UnitInterval(UnitType(IntervalPadDown(l.value())), UnitType(IntervalPadUp(h.value()))); }
+
+    static UnitInterval Entire()
+    {
+        return UnitInterval(UnitType(-std::numeric_limits<double>::infinity()), UnitType(std::numeric_limits<double>::infinity()));
+    }
+
+    UnitType Mid() const { return 0.5 * (lo + hi); }
+    UnitType Width() const { return hi - lo; }
+    bool Contains(const UnitType& v) const { return lo <= v && v <= hi; }
+    double value() const { return Mid().value(); }
+};
+
+template <class T> struct is_unit_interval : std::false_type {};
+template <class U> struct is_unit_interval<UnitInterval<U>> : std::true_type {};
+
+template <class U> struct QuantityOf<Interval, U> { using type = UnitInterval<U>; };
+
+template <class U> inline double ValueOf(const UnitInterval<U>& q) { return q.value(); }
+
+template <class U> inline UnitInterval<U> Hull(const UnitInterval<U>& a, const UnitInterval<U>& b)
+{
+    return UnitInterval<U>(std::min(a.lo, b.lo), std::max(a.hi, b.hi));
+}
+
+/// Interval over the four endpoint combinations
+template <class R>
+inline UnitInterval<R> UnitIntervalFromProducts(const R& p0, const R& p1, const R& p2, const R& p3)
+{
+    return UnitInterval<R>::Outward(std::min(std::min(p0, p1), std::min(p2, p3)), std::max(std::max(p0, p1), std::max(p2, p3)));
+}
+
+//------------------------------------------------------------------------------
+// Arithmetic, interval with interval
+
+template <class A, class B>
+inline auto operator+(const UnitInterval<A>& a, const UnitInterval<B>& b)
+{
+    using R = decltype(a.lo + b.lo);
+    return UnitInterval<R>::Outward(a.lo + b.lo, a.hi + b.hi);
+}
+
+template <class A, class B>
+inline auto operator-(const UnitInterval<A>& a, const UnitInterval<B>& b)
+{
+    using R = decltype(a.lo - b.lo);
+    return UnitInterval<R>::Outward(a.lo - b.hi, a.hi - b.lo);
+}
+
+template <class A>
+inline UnitInterval<A> operator-(const UnitInterval<A>& a)
+{
+    return UnitInterval<A>(-a.hi, -a.lo);
+}
+
+template <class A>
+inline auto Sqr(const UnitInterval<A>& a)
+{
+    using R = decltype(a.lo * a.lo);
+    R l = a.lo * a.lo;
+    R h = a.hi * a.hi;
+    if (a.lo <= A(0.0) && a.hi >= A(0.0))
+        return UnitInterval<R>(R(0.0), R(IntervalPadUp(std::max(l, h).value())));
+    return UnitInterval<R>::Outward(std::min(l, h), std::max(l, h));
+}
+
+template <class A, class B>
+inline auto operator*(const UnitInterval<A>& a, const UnitInterval<B>& b)
+{
+    using R = decltype(a.lo * b.lo);
+    // x * x of the same variable cannot go negative
+    if constexpr (std::is_same<A, B>::value)
+    {
+        if (&a == &b)
+            return Sqr(a);
+    }
+    return UnitIntervalFromProducts<R>(a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi);
+}
+
+template <class A, class B>
+inline auto operator/(const UnitInterval<A>& a, const UnitInterval<B>& b)
+{
+    using R = decltype(a.lo / b.lo);
+    if (b.lo <= B(0.0) && b.hi >= B(0.0))
+        return UnitInterval<R>::Entire();
+    return UnitIntervalFromProducts<R>(a.lo / b.lo, a.lo / b.hi, a.hi / b.lo, a.hi / b.hi);
+}
+
+//------------------------------------------------------------------------------
+// Arithmetic with constants (plain unit_t or arithmetic), the sign of the constant picks the bound order
+
+template <class A, class K, std::enable_if_t<!is_unit_interval<K>::value, int> = 0>
+inline auto operator+(const UnitInterval<A>& a, const K& k)
+{
+    using R = decltype(a.lo + k);
+    return UnitInterval<R>::Outward(a.lo + k, a.hi + k);
+}
+
+template <class A, class K, std::enable_if_t<!is_unit_interval<K>::value, int> = 0>
+inline auto operator+(const K& k, const UnitInterval<A>& a)
+{
+    return a + k;
+}
+
+template <class A, class K, std::enable_if_t<!is_unit_interval<K>::value, int> = 0>
+inline auto operator-(const UnitInterval<A>& a, const K& k)
+{
+    using R = decltype(a.lo - k);
+    return UnitInterval<R>::Outward(a.lo - k, a.hi - k);
+}
+
+template <class A, class K, std::enable_if_t<!is_unit_interval<K>::value, int> = 0>
+inline auto operator-(const K& k, const UnitInterval<A>& a)
+{
+    using R = decltype(k - a.lo);
+    return UnitInterval<R>::Outward(k - a.hi, k - a.lo);
+}
+
+template <class A, class K, std::enable_if_t<!is_unit_interval<K>::value, int> = 0>
+inline auto operator*(const UnitInterval<A>& a, const K& k)
+{
+    using R = decltype(a.lo * k);
+    R l = a.lo * k;
+    R h = a.hi * k;
+    return UnitInterval<R>::Outward(std::min(l, h), std::max(l, h));
+}
+
+template <class A, class K, std::enable_if_t<!is_unit_interval<K>::value, int> = 0>
+inline auto operator*(const K& k, const UnitInterval<A>& a)
+{
+    using R = decltype(k * a.lo);
+    R l = k * a.lo;
+    R h = k * a.hi;
+    return UnitInterval<R>::Outward(std::min(l, h), std::max(l, h));
+}
+
+template <class A, class K, std::enable_if_t<!is_unit_interval<K>::value, int> = 0>
+inline auto operator/(const UnitInterval<A>& a, const K& k)
+{
+    using R = decltype(a.lo / k);
+    R l = a.lo / k;
+    R h = a.hi / k;
+    return UnitInterval<R>::Outward(std::min(l, h), std::max(l, h));
+}
+
+template <class A, class K, std::enable_if_t<!is_unit_interval<K>::value, int> = 0>
+inline auto operator/(const K& k, const UnitInterval<A>& a)
+{
+    using R = decltype(k / a.lo);
+    if (a.lo <= A(0.0) && a.hi >= A(0.0))
+        return UnitInterval<R>::Entire();
+    R l = k / a.lo;
+    R h = k / a.hi;
+    return UnitInterval<R>::Outward(std::min(l, h), std::max(l, h));
+}
+
+//------------------------------------------------------------------------------
+// units::math overloads, picked over the generic unit_t templates by partial ordering
+
+namespace units
+{
+    namespace math
+    {
+        /// Domain restricted to x >= 0, i.e. encloses the real square roots of the interval
+        template <class U>
+        inline auto sqrt(const UnitInterval<U>& a)
+        {
+            using R = decltype(units::math::sqrt(a.lo));
+            return UnitInterval<R>::Outward(units::math::sqrt(std::max(a.lo, U(0.0))), units::math::sqrt(a.hi));
+        }
+
+        template <class U>
+        inline UnitInterval<angle::radian_t> atan(const UnitInterval<U>& a)
+        {
+            return UnitInterval<angle::radian_t>::Outward(units::math::atan(a.lo), units::math::atan(a.hi));
+        }
+
+        template <class U>
+        inline UnitInterval<dimensionless::scalar_t> tan(const UnitInterval<U>& a)
+        {
+            Interval r = ::tan(Interval(angle::radian_t(a.lo).value(), angle::radian_t(a.hi).value()));
+            return UnitInterval<dimensionless::scalar_t>(dimensionless::scalar_t(r.lo), dimensionless::scalar_t(r.hi));
+        }
+
+        template <class U>
+        inline UnitInterval<dimensionless::scalar_t> cos(const UnitInterval<U>& a)
+        {
+            Interval r = ::cos(Interval(angle::radian_t(a.lo).value(), angle::radian_t(a.hi).value()));
+            return UnitInterval<dimensionless::scalar_t>(dimensionless::scalar_t(r.lo), dimensionless::scalar_t(r.hi));
+        }
+
+        template <class U>
+        inline UnitInterval<dimensionless::scalar_t> sin(const UnitInterval<U>& a)
+        {
+            Interval r = ::sin(Interval(angle::radian_t(a.lo).value(), angle::radian_t(a.hi).value()));
+            return UnitInterval<dimensionless::scalar_t>(dimensionless::scalar_t(r.lo), dimensionless::scalar_t(r.hi));
+        }
+    }
+}
+
+/// Clamps both bounds of the launch angle, returns true if any part of the interval was clamped.
+/// The clamped arc equations in SolveShotT() also hold for unclamped angles, so the solver takes
+/// that path and the result encloses both cases.
+template <class U>
+inline bool ClampLaunchAngle(UnitInterval<U>& angle, units::angle::degree_t minAngle, units::angle::degree_t maxAngle)
+{
+    units::angle::degree_t lo = angle.lo;
+    units::angle::degree_t hi = angle.hi;
+    bool bClamped = lo < minAngle - units::angle::degree_t(0.0001) || hi > maxAngle + units::angle::degree_t(0.0001);
+    angle = UnitInterval<U>(std::clamp(lo, minAngle, maxAngle), std::clamp(hi, minAngle, maxAngle));
+    return bClamped;
+}
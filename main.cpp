@@ -2,10 +2,46 @@
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
 
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
 #include "Calculations.h"
+#include "ColumnFile.h"
+#include "SweepCache.h"
+#include "SweepWriter.h"
 
 int main(int argc, char *argv[])
 {
+    // --sweep <file|-> streams the default shooter's solution table as CSV and exits without the UI,
+    // --sweep-columns <file> writes it as a column file (ColumnFile.h) and --sweep-cache <dir> maps it
+    // from a sweep cache (SweepCache.h), solving and storing it on a miss
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--sweep") == 0)
+        {
+            SweepWriter writer(argv[i + 1]);
+            return writer.IsOpen() && WriteShotSweep(ShooterConfig(), ShotSweepGrid(), writer) ? 0 : 1;
+        }
+        if (std::strcmp(argv[i], "--sweep-columns") == 0)
+            return WriteShotSweepColumns(ShooterConfig(), ShotSweepGrid(), argv[i + 1]) ? 0 : 1;
+        if (std::strcmp(argv[i], "--sweep-cache") == 0)
+        {
+            SweepCache cache(argv[i + 1]);
+            ColumnFileReader table;
+            auto begin = std::chrono::steady_clock::now();
+            bool bLoaded = cache.Open(ShooterConfig(), ShotSweepGrid(), table);
+            double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+            if (!bLoaded)
+            {
+                std::cerr << "Sweep table unavailable in " << cache.Directory() << '\n';
+                return 1;
+            }
+            std::cout << "Sweep table " << (cache.Hits() > 0 ? "cached" : "solved") << ": " << table.Rows() << " rows in " << elapsedMs << " ms\n";
+            return 0;
+        }
+    }
+
     QGuiApplication app(argc, argv);
 
     QQmlApplicationEngine engine;
@@ -78,5 +114,11 @@ int main(int argc, char *argv[])
     }
 #endif
 
-    return app.exec();
+    int result = app.exec();
+
+    // --solver-stats prints the solver counters and latency percentiles on exit
+    if (app.arguments().contains(QStringLiteral("--solver-stats")))
+        WriteSolverStats(std::cout, TakeSolverStats());
+
+    return result;
 }